@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    Process-wide pool of analysis threads, shared by every plugin instance
+    through a SharedResourcePointer. Instances register their per-channel
+    pitch analysers, and the audio callback never runs an FFT itself.
+
+    Every slot has a home worker. After pushing a block, the audio thread
+    calls wake() and the home worker is signalled if it was asleep. A worker
+    that is awake drains its own slots, then any other slot it finds with
+    pending samples, and sleeps only once a whole pass found nothing.
+
+  ==============================================================================
+*/
+
+#include "AnalysisService.h"
+
+//==============================================================================
+class AnalysisService::Worker  : public juce::Thread
+{
+public:
+    Worker (AnalysisService& ownerService, int indexInPool)
+        : juce::Thread ("Feedback pitch analysis " + juce::String (indexInPool + 1)),
+          owner (ownerService), index (indexInPool)
+    {
+       #if FEEDBACK_ENABLE_PROFILING
+        static_assert (Profiler::numWriters > maxWorkers, "every worker needs its own profiler histograms");
+        scratch.profilerWriter = index + 1;
+       #endif
+    }
+
+    ~Worker() override
+    {
+        stopThread (1000);
+    }
+
+    // audio thread - signals the worker only if it has gone to sleep since the last wake
+    void wake() noexcept
+    {
+        if (sleeping.exchange (false))
+            notify();
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (owner.runPass (index, scratch))
+                continue;
+
+            // announce the sleep, then look once more - a push that landed before the flag was
+            // set saw us awake and didn't signal, so this pass is the only thing that would catch it
+            sleeping.store (true);
+            if (owner.runPass (index, scratch))
+            {
+                sleeping.store (false);
+                continue;
+            }
+
+            wait (idleTimeoutMs);
+            sleeping.store (false);
+        }
+    }
+
+    AnalysisService& owner;
+    const int index;
+    PitchAnalyser::Scratch scratch;
+    std::atomic<bool> sleeping { false };
+};
+
+//==============================================================================
+AnalysisService::AnalysisService()
+{
+    // leave a core for the host's audio thread
+    numWorkers = juce::jlimit (1, maxWorkers, juce::SystemStats::getNumCpus() - 1);
+
+    for (auto i = 0; i < numWorkers; i++)
+        workers.push_back (std::make_unique<Worker> (*this, i));
+
+    for (auto& worker : workers)
+        worker->startThread();
+}
+
+AnalysisService::~AnalysisService()
+{
+    // every instance has to have removed its analysers before the last reference goes
+    jassert (std::none_of (slots.begin(), slots.end(), [] (const Slot& slot) { return slot.analyser.load() != nullptr; }));
+
+    // all of them stop before any is destroyed, a running pass may still touch the others' slots
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto& worker : workers)
+        worker->stopThread (1000);
+
+    workers.clear();
+}
+
+int AnalysisService::add (PitchAnalyser& analyser)
+{
+    const juce::ScopedLock sl (registrationLock);
+
+    const auto free = std::find_if (slots.begin(), slots.end(), [] (const Slot& slot) { return slot.analyser.load() == nullptr; });
+    if (free == slots.end())
+    {
+        jassertfalse;   // more analysers than the pool was sized for, this one won't be serviced
+        return -1;
+    }
+
+    free->analyser.store (&analyser);
+
+    const auto index = static_cast<int> (free - slots.begin());
+    if (index >= numSlotsUsed.load())
+        numSlotsUsed.store (index + 1);
+
+    return index;
+}
+
+void AnalysisService::remove (PitchAnalyser& analyser)
+{
+    const juce::ScopedLock sl (registrationLock);
+
+    for (auto& slot : slots)
+    {
+        if (slot.analyser.load() != &analyser)
+            continue;
+
+        // a worker that claims the slot from here on finds it empty - wait out one that already had it
+        slot.analyser.store (nullptr);
+        while (slot.busy.load())
+            juce::Thread::yield();
+    }
+}
+
+void AnalysisService::wake (int slot) noexcept
+{
+    if (slot >= 0)
+        workers[(size_t) (slot % numWorkers)]->wake();
+}
+
+//==============================================================================
+// each worker drains its own share of the slots first, then takes whatever pending work the others haven't got to yet
+bool AnalysisService::runPass (int workerIndex, PitchAnalyser::Scratch& scratch)
+{
+    const auto numSlots = numSlotsUsed.load();
+    auto didWork = false;
+
+    for (auto i = workerIndex; i < numSlots; i += numWorkers)
+        didWork = service (slots[(size_t) i], scratch) || didWork;
+
+    for (auto i = 0; i < numSlots; i++)
+        if (i % numWorkers != workerIndex)
+            didWork = service (slots[(size_t) i], scratch) || didWork;
+
+    return didWork;
+}
+
+bool AnalysisService::service (Slot& slot, PitchAnalyser::Scratch& scratch)
+{
+    if (slot.analyser.load() == nullptr || slot.busy.exchange (true))
+        return false;
+
+    // only look inside once the slot is ours - remove() may have emptied it in between,
+    // and until busy is set nothing stops the analyser being destroyed
+    auto* analyser = slot.analyser.load();
+    const auto hasWork = analyser != nullptr && analyser->hasPendingSamples();
+
+    if (hasWork)
+        analyser->processPendingSamples (scratch);
+
+    slot.busy.store (false);
+    return hasWork;
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    Process-wide pool of analysis threads, shared by every plugin instance
+    through a SharedResourcePointer. Instances register their per-channel
+    pitch analysers, and the audio callback never runs an FFT itself.
+
+    Every slot has a home worker. After pushing a block, the audio thread
+    calls wake() and the home worker is signalled if it was asleep. A worker
+    that is awake drains its own slots, then any other slot it finds with
+    pending samples, and sleeps only once a whole pass found nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PitchAnalyser.h"
+
+//==============================================================================
+/**
+*/
+class AnalysisService
+{
+public:
+    //==============================================================================
+    AnalysisService();
+    ~AnalysisService();
+
+    // message thread - the analyser is serviced from now until remove(), prepare it first.
+    // Returns the slot to pass to wake(), or -1 if the pool is full
+    int add (PitchAnalyser& analyser);
+
+    // message thread - returns once no worker is inside the analyser any more
+    void remove (PitchAnalyser& analyser);
+
+    // audio thread - samples were pushed into the analyser in this slot. Only signals the
+    // home worker if it's asleep, so that's at most one signal per worker per idle period
+    void wake (int slot) noexcept;
+
+    int getNumWorkers() const noexcept          { return numWorkers; }
+
+    static constexpr auto maxAnalysers = 256;   /* 64 quad instances */
+    static constexpr auto maxWorkers = 8;
+    static constexpr auto idleTimeoutMs = 100;  /* backstop only, a sleeping worker is woken by wake() */
+
+private:
+    //==============================================================================
+    class Worker;
+
+    // an analyser is only ever drained by the worker that set busy
+    struct Slot
+    {
+        std::atomic<PitchAnalyser*> analyser { nullptr };
+        std::atomic<bool> busy { false };
+    };
+
+    bool runPass (int workerIndex, PitchAnalyser::Scratch& scratch);
+    bool service (Slot& slot, PitchAnalyser::Scratch& scratch);
+
+    std::array<Slot, maxAnalysers> slots;
+    std::atomic<int> numSlotsUsed { 0 };    // high-water mark, so the workers don't scan empty slots
+    juce::CriticalSection registrationLock;
+    int numWorkers = 1;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisService)
+};
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    Channel-count specialised inner loops for the processor. prepareToPlay
+    picks a set for the bus width it was given, so the mono, stereo and quad
+    paths run with the channel loop unrolled at compile time.
+
+  ==============================================================================
+*/
+
+#include "ChannelKernels.h"
+
+namespace
+{
+    // N == 0 means the count is only known at runtime
+    template <int N>
+    void sumToMid (float* mid, const float* const* channels, int numChannels, int offset, int numSamples) noexcept
+    {
+        constexpr auto fixed = N > 0;
+        const auto count = fixed ? N : numChannels;
+        const auto scale = 1.0f / static_cast<float> (count);
+
+        if (fixed && N > 1)
+        {
+            // one pass over the block with every channel read per sample, instead of a pass per channel.
+            // Only mid is stored to, so with the channel count fixed the compiler vectorises this behind one overlap check
+            for (auto i = 0; i < numSamples; i++)
+            {
+                auto sum = 0.0f;
+                for (auto ch = 0; ch < count; ch++)
+                    sum += channels[ch][offset + i];
+
+                mid[i] = sum * scale;
+            }
+        }
+        else if (fixed)
+        {
+            juce::FloatVectorOperations::copy (mid, channels[0] + offset, numSamples);
+        }
+        else
+        {
+            // with a runtime count the fused loop stays scalar, a vectorised pass per channel is several times faster
+            juce::FloatVectorOperations::copyWithMultiply (mid, channels[0] + offset, scale, numSamples);
+            for (auto ch = 1; ch < count; ch++)
+                juce::FloatVectorOperations::addWithMultiply (mid, channels[ch] + offset, scale, numSamples);
+        }
+    }
+
+    template <int N>
+    void addToAll (float* const* channels, int numChannels, int offset, const float* tone, const float* gains, int numSamples) noexcept
+    {
+        const auto count = N > 0 ? N : numChannels;
+
+        // a vectorised pass per channel - a single pass storing to every channel per sample can't be
+        // vectorised, because the compiler has to assume the channel pointers overlap
+        for (auto ch = 0; ch < count; ch++)
+            juce::FloatVectorOperations::addWithMultiply (channels[ch] + offset, tone, gains, numSamples);
+    }
+
+    template <int N>
+    constexpr ChannelKernels makeKernels() noexcept
+    {
+        return { N, sumToMid<N>, addToAll<N> };
+    }
+
+    constexpr ChannelKernels genericKernels = makeKernels<0>();
+}
+
+//==============================================================================
+ChannelKernels ChannelKernels::forChannels (int numChannels) noexcept
+{
+    switch (numChannels)
+    {
+        case 1:  return makeKernels<1>();
+        case 2:  return makeKernels<2>();
+        case 4:  return makeKernels<4>();
+        default: return genericKernels;
+    }
+}
+
+const ChannelKernels& ChannelKernels::orGenericFor (int numChannelsInBlock) const noexcept
+{
+    return numChannelsInBlock == numChannels ? *this : genericKernels;
+}
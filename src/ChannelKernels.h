@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    Channel-count specialised inner loops for the processor. prepareToPlay
+    picks a set for the bus width it was given, so the mono, stereo and quad
+    paths run with the channel loop unrolled at compile time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+struct ChannelKernels
+{
+    // mid = (sum of every channel) / numChannels, reading from sample offset onwards
+    using SumToMid = void (*) (float* mid, const float* const* channels, int numChannels, int offset, int numSamples) noexcept;
+
+    // channels[ch][offset + i] += tone[i] * gains[i] on every channel - the linked mode mix
+    using AddToAll = void (*) (float* const* channels, int numChannels, int offset, const float* tone, const float* gains, int numSamples) noexcept;
+
+    // 1, 2 and 4 channels get their own kernels, anything else the runtime loop
+    static ChannelKernels forChannels (int numChannels) noexcept;
+
+    // the selected set only covers the width it was made for - a block with a different count takes the runtime loop
+    const ChannelKernels& orGenericFor (int numChannels) const noexcept;
+
+    int numChannels = 0;
+    SumToMid sumToMid = nullptr;
+    AddToAll addToAll = nullptr;
+};
@@ -0,0 +1,261 @@
+/*
+  ==============================================================================
+
+    Anti-aliased integer decimator that brings the host rate down to the
+    guitar band before analysis. Only the retained output phase of the FIR
+    is ever computed (polyphase form), so the cost is numTaps per output.
+
+    The common host rates (44.1/48 kHz and their doubles and quadruples) get
+    a precompiled cascade: half-band 2:1 stages down to 44.1/48, then one
+    fixed-length 4:1 FIR, all with their tap counts known at compile time.
+    That keeps the analysis rate, resolution and cost per second of audio
+    about the same at every rate. Anything else falls back to one FIR
+    sized at run time.
+
+  ==============================================================================
+*/
+
+#include "Decimator.h"
+
+//==============================================================================
+void Decimator::prepare (double sampleRate, double minOutputRate, double passbandEdge)
+{
+    const auto numHalfbands = getNumHalfbands (sampleRate);
+    const auto baseRate = sampleRate / (1 << juce::jmax (0, numHalfbands));
+
+    if (numHalfbands >= 0 && baseRate / baseFactor >= minOutputRate)
+    {
+        factor = baseFactor << numHalfbands;
+        outputSampleRate = sampleRate / factor;
+
+        const auto design = designLowpass (baseRate, outputSampleRate, passbandEdge, baseTaps - 1);
+        std::copy (design.rbegin(), design.rend(), baseStage.coefficients.begin());
+
+        // each stage's delay counts in its own input samples, so scale up to the host rate
+        latencySamples = ((baseTaps - 1) / 2) << numHalfbands;
+        for (auto stage = 0; stage < numHalfbands; stage++)
+        {
+            halfbands[(size_t) stage].design();
+            latencySamples += HalfbandStage<halfbandTaps>::centre << stage;
+        }
+
+        constexpr Kernel cascades[] = { &Decimator::processCascade<0>, &Decimator::processCascade<1>, &Decimator::processCascade<2> };
+        kernel = cascades[numHalfbands];
+    }
+    else
+    {
+        factor = juce::jmax (1, static_cast<int> (sampleRate / minOutputRate));
+        outputSampleRate = sampleRate / factor;
+
+        if (factor == 1)
+            coefficients.assign (1, 1.0f);
+        else
+            coefficients = designLowpass (sampleRate, outputSampleRate, passbandEdge, tapsPerFactor * factor);
+
+        std::reverse (coefficients.begin(), coefficients.end());
+        numTaps = static_cast<int> (coefficients.size());
+        delayLine.assign (static_cast<size_t> (numTaps * 2), 0.0f);
+        latencySamples = (numTaps - 1) / 2;
+        kernel = &Decimator::processGeneric;
+    }
+
+    reset();
+}
+
+void Decimator::reset() noexcept
+{
+    for (auto& stage : halfbands)
+        stage.reset();
+
+    baseStage.reset();
+
+    std::fill (delayLine.begin(), delayLine.end(), 0.0f);
+    writeIndex = 0;
+    phase = 0;
+}
+
+// 44.1 / 48 kHz times 1, 2 or 4 -> number of half-band stages, -1 for anything else
+int Decimator::getNumHalfbands (double sampleRate) noexcept
+{
+    for (auto stages = 0; stages <= maxHalfbands; stages++)
+    {
+        const auto baseRate = sampleRate / (1 << stages);
+        if (std::abs (baseRate - 44100.0) < 1.0 || std::abs (baseRate - 48000.0) < 1.0)
+            return stages;
+    }
+
+    return -1;
+}
+
+// cutoff halfway between the top of the guitar band and the output nyquist
+std::vector<float> Decimator::designLowpass (double sampleRate, double outputRate, double passbandEdge, int order)
+{
+    const auto cutoff = static_cast<float> (0.5 * (passbandEdge + outputRate * 0.5));
+    auto design = juce::dsp::FilterDesign<float>::designFIRLowpassWindowMethod (cutoff, sampleRate, static_cast<size_t> (order),
+                                                                                juce::dsp::WindowingFunction<float>::blackmanHarris);
+    return design->coefficients;
+}
+
+//==============================================================================
+template <int NumHalfbands>
+int Decimator::processCascade (const float* input, int numSamples, float* output) noexcept
+{
+    auto numOut = 0;
+
+    // bounded chunks so the intermediate rates fit the scratch buffers
+    for (auto start = 0; start < numSamples; start += scratchSize)
+    {
+        auto num = juce::jmin (scratchSize, numSamples - start);
+        const auto* stageInput = input + start;
+
+        if constexpr (NumHalfbands >= 1)
+        {
+            num = halfbands[0].process (stageInput, num, scratchA.data());
+            stageInput = scratchA.data();
+        }
+
+        if constexpr (NumHalfbands >= 2)
+        {
+            num = halfbands[1].process (stageInput, num, scratchB.data());
+            stageInput = scratchB.data();
+        }
+
+        numOut += baseStage.process (stageInput, num, output + numOut);
+    }
+
+    return numOut;
+}
+
+int Decimator::processGeneric (const float* input, int numSamples, float* output) noexcept
+{
+    auto numOut = 0;
+
+    for (auto i = 0; i < numSamples; i++)
+    {
+        delayLine[(size_t) writeIndex] = input[i];
+        delayLine[(size_t) (writeIndex + numTaps)] = input[i];
+        writeIndex = (writeIndex + 1 == numTaps) ? 0 : writeIndex + 1;
+
+        if (++phase < factor)
+            continue;
+
+        phase = 0;
+
+        // oldest sample first, matching the reversed coefficients; four partial sums so it vectorises
+        const auto* x = delayLine.data() + writeIndex;
+        const auto* h = coefficients.data();
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        auto k = 0;
+
+        for (; k + 4 <= numTaps; k += 4)
+        {
+            sum0 += h[k]     * x[k];
+            sum1 += h[k + 1] * x[k + 1];
+            sum2 += h[k + 2] * x[k + 2];
+            sum3 += h[k + 3] * x[k + 3];
+        }
+        for (; k < numTaps; k++)
+            sum0 += h[k] * x[k];
+
+        output[numOut++] = (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    return numOut;
+}
+
+//==============================================================================
+template <int NumTaps, int Factor>
+void Decimator::FirStage<NumTaps, Factor>::reset() noexcept
+{
+    buffer.fill (0.0f);
+    phase = 0;
+}
+
+// with the trip counts known the compiler unrolls and vectorises the dot product fully
+template <int NumTaps, int Factor>
+int Decimator::FirStage<NumTaps, Factor>::process (const float* input, int numSamples, float* output) noexcept
+{
+    constexpr auto history = NumTaps - 1;
+    std::copy (input, input + numSamples, buffer.begin() + history);
+    const auto end = history + numSamples;
+    auto numOut = 0;
+
+    // phase counts the inputs since the last output, so the next one completes Factor - phase samples in
+    for (auto last = history + Factor - 1 - phase; last < end; last += Factor)
+    {
+        const auto* x = buffer.data() + last - history;
+        std::array<float, 4> sums {};
+
+        for (auto k = 0; k + 4 <= NumTaps; k += 4)
+            for (auto lane = 0; lane < 4; lane++)
+                sums[(size_t) lane] += coefficients[(size_t) (k + lane)] * x[k + lane];
+
+        for (auto k = NumTaps - NumTaps % 4; k < NumTaps; k++)
+            sums[0] += coefficients[(size_t) k] * x[k];
+
+        output[numOut++] = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+
+    phase = (phase + numSamples) % Factor;
+    std::copy (buffer.begin() + numSamples, buffer.begin() + end, buffer.begin());
+    return numOut;
+}
+
+//==============================================================================
+// windowed sinc at a quarter of the input rate - the sinc is exactly zero at even offsets
+template <int NumTaps>
+void Decimator::HalfbandStage<NumTaps>::design()
+{
+    const auto window = [] (int index)
+    {
+        const auto x = juce::MathConstants<double>::twoPi * index / (NumTaps - 1);
+        return 0.35875 - 0.48829 * std::cos (x) + 0.14128 * std::cos (2.0 * x) - 0.01168 * std::cos (3.0 * x);
+    };
+
+    auto dcGain = 0.5;
+    std::array<double, (size_t) numOddTaps> taps {};
+
+    for (auto j = 0; j < numOddTaps; j++)
+    {
+        const auto offset = 2 * j + 1;
+        const auto sinc = std::sin (juce::MathConstants<double>::halfPi * offset) / (juce::MathConstants<double>::pi * offset);
+        taps[(size_t) j] = sinc * window (centre + offset);
+        dcGain += 2.0 * taps[(size_t) j];
+    }
+
+    centreCoefficient = static_cast<float> (0.5 / dcGain);
+    for (auto j = 0; j < numOddTaps; j++)
+        oddCoefficients[(size_t) j] = static_cast<float> (taps[(size_t) j] / dcGain);
+}
+
+template <int NumTaps>
+void Decimator::HalfbandStage<NumTaps>::reset() noexcept
+{
+    buffer.fill (0.0f);
+    phase = 0;
+}
+
+template <int NumTaps>
+int Decimator::HalfbandStage<NumTaps>::process (const float* input, int numSamples, float* output) noexcept
+{
+    constexpr auto history = NumTaps - 1;
+    std::copy (input, input + numSamples, buffer.begin() + history);
+    const auto end = history + numSamples;
+    auto numOut = 0;
+
+    for (auto last = history + 1 - phase; last < end; last += 2)
+    {
+        // symmetric, so each stored tap multiplies the pair of samples either side of the centre
+        const auto* x = buffer.data() + last - centre;
+        auto sum = centreCoefficient * x[0];
+
+        for (auto j = 0; j < numOddTaps; j++)
+            sum += oddCoefficients[(size_t) j] * (x[-(2 * j + 1)] + x[2 * j + 1]);
+
+        output[numOut++] = sum;
+    }
+
+    phase = (phase + numSamples) & 1;
+    std::copy (buffer.begin() + numSamples, buffer.begin() + end, buffer.begin());
+    return numOut;
+}
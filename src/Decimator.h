@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    Anti-aliased integer decimator that brings the host rate down to the
+    guitar band before analysis. Only the retained output phase of the FIR
+    is ever computed (polyphase form), so the cost is numTaps per output.
+
+    The common host rates (44.1/48 kHz and their doubles and quadruples) get
+    a precompiled cascade: half-band 2:1 stages down to 44.1/48, then one
+    fixed-length 4:1 FIR, all with their tap counts known at compile time.
+    That keeps the analysis rate, resolution and cost per second of audio
+    about the same at every rate. Anything else falls back to one FIR
+    sized at run time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class Decimator
+{
+public:
+    //==============================================================================
+    Decimator() = default;
+
+    // message thread - picks the kernel for this rate, and the largest factor that keeps the output at or above minOutputRate
+    void prepare (double sampleRate, double minOutputRate, double passbandEdge);
+    void reset() noexcept;
+
+    // writes at most numSamples / factor + 1 samples to output and returns how many it wrote
+    int process (const float* input, int numSamples, float* output) noexcept   { return (this->*kernel) (input, numSamples, output); }
+
+    int getFactor() const noexcept              { return factor; }
+    double getOutputSampleRate() const noexcept { return outputSampleRate; }
+
+    // group delay of the whole (linear-phase) chain, in input samples
+    int getLatencySamples() const noexcept      { return latencySamples; }
+
+    // taps per unit of decimation - long enough to keep aliases out of the guitar band
+    static constexpr auto tapsPerFactor = 20;
+
+    // the precompiled cascade: 0, 1 or 2 half-band stages, then baseFactor
+    static constexpr auto baseFactor = 4;
+    static constexpr auto baseTaps = tapsPerFactor * baseFactor + 1;
+    static constexpr auto halfbandTaps = 19;
+    static constexpr auto maxHalfbands = 2;
+
+private:
+    //==============================================================================
+    using Kernel = int (Decimator::*) (const float*, int, float*) noexcept;
+
+    // the cascade stages work a block at a time on a linear buffer (the last NumTaps - 1 inputs, then the new
+    // block), so there is no per-sample delay-line write and every output is one contiguous dot product
+    static constexpr auto maxStageBlock = 1024;
+
+    // FIR with its length fixed at compile time, coefficients reversed
+    template <int NumTaps, int Factor>
+    struct FirStage
+    {
+        void reset() noexcept;
+        int process (const float* input, int numSamples, float* output) noexcept;
+
+        std::array<float, (size_t) NumTaps> coefficients {};
+        std::array<float, (size_t) (NumTaps - 1 + maxStageBlock)> buffer {};
+        int phase = 0;
+    };
+
+    // 2:1 half-band - every other tap is zero and the rest are symmetric, so only the odd offsets are stored
+    template <int NumTaps>
+    struct HalfbandStage
+    {
+        static_assert (NumTaps % 4 == 3, "half-band lengths are 4k + 3");
+        static constexpr auto centre = (NumTaps - 1) / 2;
+        static constexpr auto numOddTaps = (NumTaps + 1) / 4;
+
+        void design();
+        void reset() noexcept;
+        int process (const float* input, int numSamples, float* output) noexcept;
+
+        float centreCoefficient = 0.5f;
+        std::array<float, (size_t) numOddTaps> oddCoefficients {};
+        std::array<float, (size_t) (NumTaps - 1 + maxStageBlock)> buffer {};
+        int phase = 0;
+    };
+
+    template <int NumHalfbands>
+    int processCascade (const float* input, int numSamples, float* output) noexcept;
+    int processGeneric (const float* input, int numSamples, float* output) noexcept;
+
+    static int getNumHalfbands (double sampleRate) noexcept;
+    static std::vector<float> designLowpass (double sampleRate, double outputRate, double passbandEdge, int order);
+
+    Kernel kernel = &Decimator::processGeneric;
+
+    // precompiled cascade
+    static constexpr auto scratchSize = maxStageBlock;
+    std::array<HalfbandStage<halfbandTaps>, maxHalfbands> halfbands;
+    FirStage<baseTaps, baseFactor> baseStage;
+    std::array<float, scratchSize / 2 + 1> scratchA;
+    std::array<float, scratchSize / 4 + 1> scratchB;
+
+    // run-time sized fallback
+    // coefficients are stored reversed, and the delay line twice over so that
+    // every dot product reads one contiguous run
+    std::vector<float> coefficients;
+    std::vector<float> delayLine;
+    int numTaps = 1;
+    int writeIndex = 0;
+    int phase = 0;
+
+    int factor = 1;
+    int latencySamples = 0;
+    double outputSampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Decimator)
+};
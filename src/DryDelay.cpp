@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    Delays the dry signal in place, for look-ahead mode. The history is
+    allocated once for the longest delay the analysis can need; switching
+    between delays (or to none) crossfades between the two taps, so it can
+    happen at any time without a click or an allocation.
+
+  ==============================================================================
+*/
+
+#include "DryDelay.h"
+
+void DryDelay::prepare (int numChannels, int maxDelaySamples, int delaySamples)
+{
+    maxDelay = juce::jmax (0, maxDelaySamples);
+    const auto size = juce::nextPowerOfTwo (maxDelay + chunkSize);
+
+    history.setSize (juce::jmax (1, numChannels), size);
+    history.clear();
+    mask = size - 1;
+    writeIndex = 0;
+
+    currentDelay = previousDelay = juce::jlimit (0, maxDelay, delaySamples);
+    fadeRemaining = 0;
+}
+
+void DryDelay::process (juce::AudioBuffer<float>& buffer, int numChannels, int delaySamples) noexcept
+{
+    numChannels = juce::jmin (numChannels, history.getNumChannels());
+    delaySamples = juce::jlimit (0, maxDelay, delaySamples);
+
+    // a change in the middle of a fade restarts it from the tap that was fading in
+    if (delaySamples != currentDelay)
+    {
+        previousDelay = currentDelay;
+        currentDelay = delaySamples;
+        fadeRemaining = crossfadeSamples;
+    }
+
+    // with no delay and no fade the buffer already holds the output - only the history needs feeding
+    const auto passThrough = currentDelay == 0 && fadeRemaining == 0;
+
+    for (int start = 0; start < buffer.getNumSamples(); start += chunkSize)
+    {
+        const auto numSamples = juce::jmin (chunkSize, buffer.getNumSamples() - start);
+        const auto numFading = juce::jmin (fadeRemaining, numSamples);
+
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            auto* samples = buffer.getWritePointer (ch, start);
+            auto* channelHistory = history.getWritePointer (ch);
+            writeToHistory (channelHistory, samples, numSamples);
+
+            if (passThrough)
+                continue;
+
+            for (int i = 0; i < numFading; i++)
+            {
+                const auto position = static_cast<float> (crossfadeSamples - fadeRemaining + i + 1) / static_cast<float> (crossfadeSamples);
+                const auto from = channelHistory[(writeIndex + i - previousDelay + mask + 1) & mask];
+                const auto to = channelHistory[(writeIndex + i - currentDelay + mask + 1) & mask];
+                samples[i] = from + position * (to - from);
+            }
+
+            if (currentDelay > 0)
+                readFromHistory (channelHistory, samples + numFading, currentDelay - numFading, numSamples - numFading);
+        }
+
+        fadeRemaining -= numFading;
+        writeIndex = (writeIndex + numSamples) & mask;
+    }
+}
+
+// copies numSamples in at writeIndex, in two pieces if they wrap
+void DryDelay::writeToHistory (float* dest, const float* source, int numSamples) const noexcept
+{
+    const auto firstPart = juce::jmin (numSamples, mask + 1 - writeIndex);
+    juce::FloatVectorOperations::copy (dest + writeIndex, source, firstPart);
+    juce::FloatVectorOperations::copy (dest, source + firstPart, numSamples - firstPart);
+}
+
+// copies numSamples out, starting delay samples behind writeIndex
+void DryDelay::readFromHistory (const float* source, float* dest, int delay, int numSamples) const noexcept
+{
+    const auto readIndex = (writeIndex - delay + mask + 1) & mask;
+    const auto firstPart = juce::jmin (numSamples, mask + 1 - readIndex);
+    juce::FloatVectorOperations::copy (dest, source + readIndex, firstPart);
+    juce::FloatVectorOperations::copy (dest + firstPart, source, numSamples - firstPart);
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    Delays the dry signal in place, for look-ahead mode. The history is
+    allocated once for the longest delay the analysis can need; switching
+    between delays (or to none) crossfades between the two taps, so it can
+    happen at any time without a click or an allocation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class DryDelay
+{
+public:
+    //==============================================================================
+    DryDelay() = default;
+
+    // message thread - sizes the history for maxDelaySamples, clears it and starts at delaySamples
+    void prepare (int numChannels, int maxDelaySamples, int delaySamples);
+
+    // audio thread - delays the first numChannels of buffer by delaySamples (clamped to the prepared maximum).
+    // The input is always written to the history, so a delay switched on later starts from real signal
+    void process (juce::AudioBuffer<float>& buffer, int numChannels, int delaySamples) noexcept;
+
+    int getDelaySamples() const noexcept        { return currentDelay; }
+
+    // constants
+    static constexpr auto crossfadeSamples = 512;  /* ~10 ms at 48 kHz */
+    static constexpr auto chunkSize = 1024;        /* history beyond the longest delay, processed at a time */
+
+private:
+    //==============================================================================
+    void writeToHistory (float* history, const float* source, int numSamples) const noexcept;
+    void readFromHistory (const float* history, float* dest, int delay, int numSamples) const noexcept;
+
+    juce::AudioBuffer<float> history;
+    int mask = 0;
+    int writeIndex = 0;
+    int maxDelay = 0;
+    int currentDelay = 0;
+
+    // the tap being faded out, and how much of the fade is left
+    int previousDelay = 0;
+    int fadeRemaining = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DryDelay)
+};
@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Cheap time-domain attack detector for the audio thread. Compares fast and
+    slow envelopes of the input energy, both plain and pre-emphasised; a
+    picked note makes a fast one jump well above its slow one for a few
+    milliseconds.
+
+  ==============================================================================
+*/
+
+#include "OnsetDetector.h"
+
+//==============================================================================
+void OnsetDetector::prepare (double sampleRate) noexcept
+{
+    // one-pole smoothing coefficients for the given time constants
+    fastCoefficient = static_cast<float> (1.0 - std::exp (-1000.0 / (fastTimeMs * sampleRate)));
+    slowCoefficient = static_cast<float> (1.0 - std::exp (-1000.0 / (slowTimeMs * sampleRate)));
+    refractorySamples = static_cast<int> (refractoryMs * 0.001 * sampleRate);
+    reset();
+}
+
+void OnsetDetector::reset() noexcept
+{
+    fastEnvelopes.fill (0.0f);
+    slowEnvelopes.fill (0.0f);
+    previousSample = 0.0f;
+    samplesUntilArmed = 0;
+}
+
+bool OnsetDetector::process (const float* samples, int numSamples) noexcept
+{
+    auto fastPlain = fastEnvelopes[0], fastEmphasised = fastEnvelopes[1];
+    auto slowPlain = slowEnvelopes[0], slowEmphasised = slowEnvelopes[1];
+    auto previous = previousSample;
+    auto onset = false;
+
+    for (auto i = 0; i < numSamples; i++)
+    {
+        const auto emphasised = samples[i] - emphasis * previous;
+        const auto plainEnergy = samples[i] * samples[i];
+        const auto emphasisedEnergy = emphasised * emphasised;
+        previous = samples[i];
+
+        fastPlain += fastCoefficient * (plainEnergy - fastPlain);
+        slowPlain += slowCoefficient * (plainEnergy - slowPlain);
+        fastEmphasised += fastCoefficient * (emphasisedEnergy - fastEmphasised);
+        slowEmphasised += slowCoefficient * (emphasisedEnergy - slowEmphasised);
+
+        if (samplesUntilArmed > 0)
+        {
+            samplesUntilArmed--;
+        }
+        else if ((fastPlain > energyFloor && fastPlain > energyRatio * slowPlain)
+                  || (fastEmphasised > energyFloor && fastEmphasised > energyRatio * slowEmphasised))
+        {
+            onset = true;
+            samplesUntilArmed = refractorySamples;
+        }
+    }
+
+    fastEnvelopes = { fastPlain, fastEmphasised };
+    slowEnvelopes = { slowPlain, slowEmphasised };
+    previousSample = previous;
+    return onset;
+}
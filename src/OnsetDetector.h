@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    Cheap time-domain attack detector for the audio thread. Compares fast and
+    slow envelopes of the input energy, both plain and pre-emphasised; a
+    picked note makes a fast one jump well above its slow one for a few
+    milliseconds.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class OnsetDetector
+{
+public:
+    //==============================================================================
+    OnsetDetector() = default;
+
+    void prepare (double sampleRate) noexcept;
+    void reset() noexcept;
+
+    // true if an attack starts anywhere in these samples
+    bool process (const float* samples, int numSamples) noexcept;
+
+    // constants
+    static constexpr auto fastTimeMs = 2.0;
+    static constexpr auto slowTimeMs = 60.0;
+    static constexpr auto refractoryMs = 80.0;     /* one attack per pick, not one per bounce of the envelope */
+    static constexpr auto energyRatio = 4.0f;      /* fast over slow, a ~6 dB jump */
+    static constexpr auto energyFloor = 1.0e-5f;   /* about -50 dBFS, ignores noise and fret buzz */
+    static constexpr auto emphasis = 0.95f;        /* near first difference - a re-picked note still jumps in the highs */
+
+private:
+    //==============================================================================
+    float fastCoefficient = 1.0f;
+    float slowCoefficient = 1.0f;
+    // [0] plain energy catches a new low note under a ringing high one, [1] emphasised catches re-picks
+    std::array<float, 2> fastEnvelopes {};
+    std::array<float, 2> slowEnvelopes {};
+    float previousSample = 0.0f;
+    int refractorySamples = 0;
+    int samplesUntilArmed = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OnsetDetector)
+};
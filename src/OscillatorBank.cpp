@@ -0,0 +1,274 @@
+/*
+  ==============================================================================
+
+    Bank of sine voices for polyphonic feedback. Voice state is kept as
+    structure-of-arrays with one lane per voice, so every sample is rendered
+    for all voices in a single SIMD pass. Each
+    voice is a rotating phasor, re-tuned and re-normalised every sub-block.
+
+  ==============================================================================
+*/
+
+#include "OscillatorBank.h"
+
+//==============================================================================
+void OscillatorBank::prepare (double sampleRate) noexcept
+{
+    phasePerHz = static_cast<float> (4294967296.0 / sampleRate);
+
+    // same glide as the mono frequency ramp, a slightly longer fade so voices don't click in and out
+    frequencyRampLength = juce::jmax (1, juce::roundToInt (sampleRate * 0.025));
+    gainRampLength = juce::jmax (1, juce::roundToInt (sampleRate * 0.02));
+    stealRampLength = juce::jmax (1, juce::roundToInt (sampleRate * 0.005));
+    reset();
+}
+
+void OscillatorBank::reset() noexcept
+{
+    phasorRe.fill (1.0f);
+    phasorIm.fill (0.0f);
+    frequencies.fill (0.0f);
+    frequencySteps.fill (0.0f);
+    gains.fill (0.0f);
+    gainSteps.fill (0.0f);
+    targetFrequencies.fill (0.0f);
+    targetGains.fill (0.0f);
+    frequencyRemaining.fill (0);
+    gainRemaining.fill (0);
+    pendingFrequencies.fill (0.0f);
+    pendingGains.fill (0.0f);
+}
+
+void OscillatorBank::setNotes (const float* noteFrequencies, int numNotes) noexcept
+{
+    numNotes = juce::jmin (numNotes, numLanes);
+    if (numNotes <= 0)
+        return;
+
+    // each note gets an equal share so a full chord is no louder than a single voice
+    const auto share = 1.0f / static_cast<float> (numNotes);
+    std::array<bool, numLanes> taken {};
+
+    for (auto n = 0; n < numNotes; n++)
+    {
+        const auto note = noteFrequencies[n];
+        auto voice = findVoiceFor (note, taken);
+
+        if (voice >= 0 && pendingFrequencies[(size_t) voice] > 0.0f)
+        {
+            // still fading out to make room for this note - it'll start on the new pitch once silent
+            pendingFrequencies[(size_t) voice] = note;
+            pendingGains[(size_t) voice] = share;
+        }
+        else if (voice >= 0)
+        {
+            targetFrequencies[(size_t) voice] = note;
+            frequencyRemaining[(size_t) voice] = frequencyRampLength;
+            targetGains[(size_t) voice] = share;
+            gainRemaining[(size_t) voice] = gainRampLength;
+        }
+        else
+        {
+            voice = findFreeVoice (taken);
+
+            if (gains[(size_t) voice] <= 0.0f && targetGains[(size_t) voice] <= 0.0f)
+            {
+                // a silent voice starts directly on the new pitch
+                frequencies[(size_t) voice] = targetFrequencies[(size_t) voice] = note;
+                frequencyRemaining[(size_t) voice] = 0;
+                targetGains[(size_t) voice] = share;
+                gainRemaining[(size_t) voice] = gainRampLength;
+            }
+            else
+            {
+                // an audible one is faded out first, render() re-tunes it when the fade lands
+                pendingFrequencies[(size_t) voice] = note;
+                pendingGains[(size_t) voice] = share;
+                targetGains[(size_t) voice] = 0.0f;
+                gainRemaining[(size_t) voice] = gainRemaining[(size_t) voice] > 0 ? juce::jmin (gainRemaining[(size_t) voice], stealRampLength)
+                                                                                  : stealRampLength;
+            }
+        }
+
+        taken[(size_t) voice] = true;
+    }
+
+    for (auto v = 0; v < numLanes; v++)
+    {
+        if (taken[(size_t) v])
+            continue;
+
+        pendingFrequencies[(size_t) v] = 0.0f;
+
+        if (targetGains[(size_t) v] > 0.0f)
+        {
+            targetGains[(size_t) v] = 0.0f;
+            gainRemaining[(size_t) v] = gainRampLength;
+        }
+    }
+}
+
+// nearest voice within a semitone that is sounding (or about to sound) a note, or -1
+int OscillatorBank::findVoiceFor (float note, const std::array<bool, numLanes>& taken) const noexcept
+{
+    auto voice = -1;
+    auto bestDistance = 1.0f / 12.0f;
+
+    for (auto v = 0; v < numLanes; v++)
+    {
+        const auto current = pendingFrequencies[(size_t) v] > 0.0f ? pendingFrequencies[(size_t) v]
+                                                                   : (targetGains[(size_t) v] > 0.0f ? targetFrequencies[(size_t) v] : 0.0f);
+        if (taken[(size_t) v] || current <= 0.0f)
+            continue;
+
+        const auto distance = std::abs (std::log2 (note / current));
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            voice = v;
+        }
+    }
+
+    return voice;
+}
+
+// a silent voice if there is one, otherwise the quietest voice nobody has claimed
+int OscillatorBank::findFreeVoice (const std::array<bool, numLanes>& taken) const noexcept
+{
+    auto voice = -1;
+
+    for (auto v = 0; v < numLanes; v++)
+    {
+        if (taken[(size_t) v])
+            continue;
+
+        if (gains[(size_t) v] <= 0.0f && targetGains[(size_t) v] <= 0.0f)
+            return v;
+
+        if (voice < 0 || gains[(size_t) v] < gains[(size_t) voice])
+            voice = v;
+    }
+
+    return voice;
+}
+
+// turns the remaining ramps into per-sample steps for a block of numSamples. A ramp that
+// would end mid-block is stretched to the block end, so the lanes never overshoot
+void OscillatorBank::startRamps (int numSamples) noexcept
+{
+    for (auto v = 0; v < numLanes; v++)
+    {
+        const auto frequencyRun = juce::jmax (numSamples, frequencyRemaining[(size_t) v]);
+        frequencySteps[(size_t) v] = frequencyRemaining[(size_t) v] > 0 ? (targetFrequencies[(size_t) v] - frequencies[(size_t) v]) / static_cast<float> (frequencyRun)
+                                                                        : 0.0f;
+
+        const auto gainRun = juce::jmax (numSamples, gainRemaining[(size_t) v]);
+        gainSteps[(size_t) v] = gainRemaining[(size_t) v] > 0 ? (targetGains[(size_t) v] - gains[(size_t) v]) / static_cast<float> (gainRun)
+                                                              : 0.0f;
+    }
+}
+
+void OscillatorBank::render (const float* ratios, const float* detunes, float* output, int numSamples) noexcept
+{
+    startRamps (numSamples);
+
+    constexpr auto maxIncrement = 2147483520.0f;
+
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr auto numVecs = numLanes / Vec::SIMDNumElements;
+
+    // work on local copies so the compiler knows output can't alias the voice state
+    alignas (32) auto re = phasorRe;
+    alignas (32) auto im = phasorIm;
+    alignas (32) auto frequency = frequencies;
+    alignas (32) auto gain = gains;
+    alignas (32) const auto frequencyStep = frequencySteps;
+    alignas (32) const auto gainStep = gainSteps;
+
+    for (auto start = 0; start < numSamples; start += subBlockSize)
+    {
+        const auto num = juce::jmin (subBlockSize, numSamples - start);
+        const auto ratio = ratios[start + num / 2];
+        const auto detune = detunes[start + num / 2];
+        alignas (32) std::array<float, numLanes> rotationRe, rotationIm;
+
+        // per-lane rotation for this sub-block, with the gliding frequency held at its midpoint
+        for (size_t v = 0; v < numLanes; v++)
+        {
+            const auto midpoint = frequency[v] + frequencyStep[v] * (0.5f * static_cast<float> (num));
+            const auto increment = static_cast<juce::uint32> (static_cast<juce::int32> (juce::jlimit (-maxIncrement, maxIncrement, (midpoint * ratio + detune) * phasePerHz)));
+            rotationRe[v] = FastSine::fromPhase (increment + 0x40000000u);
+            rotationIm[v] = FastSine::fromPhase (increment);
+            frequency[v] += frequencyStep[v] * static_cast<float> (num);
+
+            // pull the phasor back onto the unit circle (first-order newton step is plenty per sub-block)
+            const auto correction = 1.5f - 0.5f * (re[v] * re[v] + im[v] * im[v]);
+            re[v] *= correction;
+            im[v] *= correction;
+        }
+
+        // all voices in one pass, one SIMD register per group of lanes
+        Vec vRe[numVecs], vIm[numVecs], vRotationRe[numVecs], vRotationIm[numVecs], vGain[numVecs], vGainStep[numVecs];
+        for (size_t k = 0; k < numVecs; k++)
+        {
+            const auto offset = k * Vec::SIMDNumElements;
+            vRe[k] = Vec::fromRawArray (re.data() + offset);
+            vIm[k] = Vec::fromRawArray (im.data() + offset);
+            vRotationRe[k] = Vec::fromRawArray (rotationRe.data() + offset);
+            vRotationIm[k] = Vec::fromRawArray (rotationIm.data() + offset);
+            vGain[k] = Vec::fromRawArray (gain.data() + offset);
+            vGainStep[k] = Vec::fromRawArray (gainStep.data() + offset);
+        }
+
+        for (auto i = start; i < start + num; i++)
+        {
+            auto sum = Vec::expand (0.0f);
+
+            for (size_t k = 0; k < numVecs; k++)
+            {
+                const auto nextRe = vRe[k] * vRotationRe[k] - vIm[k] * vRotationIm[k];
+                vIm[k] = vRe[k] * vRotationIm[k] + vIm[k] * vRotationRe[k];
+                vRe[k] = nextRe;
+                sum += vIm[k] * vGain[k];
+                vGain[k] += vGainStep[k];
+            }
+
+            output[i] = sum.sum();
+        }
+
+        for (size_t k = 0; k < numVecs; k++)
+        {
+            const auto offset = k * Vec::SIMDNumElements;
+            vRe[k].copyToRawArray (re.data() + offset);
+            vIm[k].copyToRawArray (im.data() + offset);
+            vGain[k].copyToRawArray (gain.data() + offset);
+        }
+    }
+
+    phasorRe = re;
+    phasorIm = im;
+    frequencies = frequency;
+    gains = gain;
+
+    // land exactly on the targets of any ramp that finished during this block
+    for (auto v = 0; v < numLanes; v++)
+    {
+        frequencyRemaining[(size_t) v] = juce::jmax (0, frequencyRemaining[(size_t) v] - numSamples);
+        if (frequencyRemaining[(size_t) v] == 0)
+            frequencies[(size_t) v] = targetFrequencies[(size_t) v];
+
+        gainRemaining[(size_t) v] = juce::jmax (0, gainRemaining[(size_t) v] - numSamples);
+        if (gainRemaining[(size_t) v] == 0)
+            gains[(size_t) v] = targetGains[(size_t) v];
+
+        // a stolen voice that has faded to silence takes its new note
+        if (gainRemaining[(size_t) v] == 0 && pendingFrequencies[(size_t) v] > 0.0f)
+        {
+            frequencies[(size_t) v] = targetFrequencies[(size_t) v] = pendingFrequencies[(size_t) v];
+            frequencyRemaining[(size_t) v] = 0;
+            targetGains[(size_t) v] = pendingGains[(size_t) v];
+            gainRemaining[(size_t) v] = gainRampLength;
+            pendingFrequencies[(size_t) v] = 0.0f;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    Bank of sine voices for polyphonic feedback. Voice state is kept as
+    structure-of-arrays with one lane per voice, so every sample is rendered
+    for all voices in a single SIMD pass. Each
+    voice is a rotating phasor, re-tuned and re-normalised every sub-block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SineOscillator.h"
+
+//==============================================================================
+/**
+*/
+class OscillatorBank
+{
+public:
+    //==============================================================================
+    OscillatorBank() = default;
+
+    void prepare (double sampleRate) noexcept;
+    void reset() noexcept;
+
+    // retargets the voices to a new set of detected notes - nearby voices glide,
+    // new notes take a silent voice and fade in, voices left without a note fade out.
+    // With no silent voice left, the quietest one is faded out first and only
+    // re-tuned once it's silent, so a stolen voice never jumps in pitch while audible
+    void setNotes (const float* noteFrequencies, int numNotes) noexcept;
+
+    // sum of all voices, with every frequency mapped through f * ratios[i] + detunes[i]. Like the
+    // glides, the mapping is followed a sub-block at a time, taken at the sub-block's midpoint
+    void render (const float* ratios, const float* detunes, float* output, int numSamples) noexcept;
+
+    // one lane per voice - 8 floats fill an AVX register (or two SSE/NEON ones)
+    static constexpr auto numLanes = 8;
+
+    // how often the rotation follows the frequency glides
+    static constexpr auto subBlockSize = 32;
+
+private:
+    //==============================================================================
+    void startRamps (int numSamples) noexcept;
+    int findVoiceFor (float note, const std::array<bool, numLanes>& taken) const noexcept;
+    int findFreeVoice (const std::array<bool, numLanes>& taken) const noexcept;
+
+    // voice state (structure-of-arrays)
+    alignas (32) std::array<float, numLanes> phasorRe {};
+    alignas (32) std::array<float, numLanes> phasorIm {};
+    alignas (32) std::array<float, numLanes> frequencies {};
+    alignas (32) std::array<float, numLanes> frequencySteps {};
+    alignas (32) std::array<float, numLanes> gains {};
+    alignas (32) std::array<float, numLanes> gainSteps {};
+
+    // ramp targets, consumed a block at a time by startRamps()
+    std::array<float, numLanes> targetFrequencies {};
+    std::array<float, numLanes> targetGains {};
+    std::array<int, numLanes> frequencyRemaining {};
+    std::array<int, numLanes> gainRemaining {};
+
+    // note a stolen voice moves to once its fade-out lands (0 = none)
+    std::array<float, numLanes> pendingFrequencies {};
+    std::array<float, numLanes> pendingGains {};
+
+    int frequencyRampLength = 1;
+    int gainRampLength = 1;
+    int stealRampLength = 1;
+    float phasePerHz = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OscillatorBank)
+};
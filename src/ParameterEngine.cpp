@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    Everything processBlock needs from the parameters. The raw atomics are
+    resolved once, read once per block, and anything that moves the sound
+    is smoothed per sample so automation doesn't zipper. Derived values
+    (the offset's frequency ratio) are only recomputed when their input
+    parameter changes.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "ParameterEngine.h"
+
+namespace
+{
+    // a steady value is a plain fill, only a moving one costs a step per sample
+    template <typename Smoothed>
+    void fillFromSmoothed (Smoothed& smoothed, float* dest, int numSamples) noexcept
+    {
+        if (! smoothed.isSmoothing())
+        {
+            juce::FloatVectorOperations::fill (dest, smoothed.getTargetValue(), numSamples);
+            return;
+        }
+
+        for (auto i = 0; i < numSamples; i++)
+            dest[i] = smoothed.getNextValue();
+    }
+}
+
+//==============================================================================
+ParameterEngine::ParameterEngine (juce::AudioProcessorValueTreeState& apvts)
+    : gainParameter (apvts.getRawParameterValue (ParamIDs::Gain)),
+      feedbackParameter (apvts.getRawParameterValue (ParamIDs::Feedback)),
+      offsetParameter (apvts.getRawParameterValue (ParamIDs::Offset)),
+      detuneParameter (apvts.getRawParameterValue (ParamIDs::Detune)),
+      voicesParameter (apvts.getRawParameterValue (ParamIDs::Voices)),
+      channelModeParameter (apvts.getRawParameterValue (ParamIDs::ChannelMode)),
+      lookAheadParameter (apvts.getRawParameterValue (ParamIDs::LookAhead)),
+      analyserParameters { apvts.getRawParameterValue (ParamIDs::Tolerance),
+                           apvts.getRawParameterValue (ParamIDs::HopSize),
+                           apvts.getRawParameterValue (ParamIDs::Detector),
+                           apvts.getRawParameterValue (ParamIDs::Voices),
+                           apvts.getRawParameterValue (ParamIDs::Hold) }
+{
+    jassert (gainParameter != nullptr && feedbackParameter != nullptr && offsetParameter != nullptr
+              && detuneParameter != nullptr && voicesParameter != nullptr && channelModeParameter != nullptr
+              && lookAheadParameter != nullptr);
+}
+
+void ParameterEngine::prepare (double sampleRate) noexcept
+{
+    feedbackGain.reset (sampleRate, gainRampSeconds);
+    outputGain.reset (sampleRate, gainRampSeconds);
+    detune.reset (sampleRate, pitchRampSeconds);
+    offsetRatio.reset (sampleRate, pitchRampSeconds);
+
+    // the first block starts where the parameters are rather than ramping in from the defaults
+    lastOffset = -1.0f;
+    beginBlock();
+    feedbackGain.setCurrentAndTargetValue (feedbackGain.getTargetValue());
+    outputGain.setCurrentAndTargetValue (outputGain.getTargetValue());
+    detune.setCurrentAndTargetValue (detune.getTargetValue());
+    offsetRatio.setCurrentAndTargetValue (offsetRatio.getTargetValue());
+}
+
+void ParameterEngine::beginBlock() noexcept
+{
+    feedbackGain.setTargetValue (feedbackParameter->load (std::memory_order_relaxed));
+    outputGain.setTargetValue (gainParameter->load (std::memory_order_relaxed));
+    detune.setTargetValue (detuneParameter->load (std::memory_order_relaxed));
+
+    // the pow only runs when the offset moves
+    const auto offset = offsetParameter->load (std::memory_order_relaxed);
+    if (offset != lastOffset)
+    {
+        offsetRatio.setTargetValue (static_cast<float> (std::pow (semitoneConstant, offset)));
+        lastOffset = offset;
+    }
+
+    polyphonic = voicesParameter->load (std::memory_order_relaxed) > 1.0f;
+    independent = channelModeParameter->load (std::memory_order_relaxed) >= 0.5f;
+    lookAhead = lookAheadParameter->load (std::memory_order_relaxed) >= 0.5f;
+}
+
+//==============================================================================
+void ParameterEngine::fillFeedbackGains (float* dest, int numSamples) noexcept   { fillFromSmoothed (feedbackGain, dest, numSamples); }
+void ParameterEngine::fillOffsetRatios (float* dest, int numSamples) noexcept    { fillFromSmoothed (offsetRatio, dest, numSamples); }
+void ParameterEngine::fillDetunes (float* dest, int numSamples) noexcept         { fillFromSmoothed (detune, dest, numSamples); }
+void ParameterEngine::fillOutputGains (float* dest, int numSamples) noexcept     { fillFromSmoothed (outputGain, dest, numSamples); }
+
+PitchAnalyser::Parameters ParameterEngine::getAnalyserParameters() const noexcept
+{
+    return analyserParameters;
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    Everything processBlock needs from the parameters. The raw atomics are
+    resolved once, read once per block, and anything that moves the sound
+    is smoothed per sample so automation doesn't zipper. Derived values
+    (the offset's frequency ratio) are only recomputed when their input
+    parameter changes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PitchAnalyser.h"
+
+//==============================================================================
+/**
+*/
+class ParameterEngine
+{
+public:
+    //==============================================================================
+    // the value tree has to outlive the engine - only its atomics are kept
+    explicit ParameterEngine (juce::AudioProcessorValueTreeState& apvts);
+
+    // message thread - sets the ramp lengths and jumps every smoothed value to the current setting
+    void prepare (double sampleRate) noexcept;
+
+    // audio thread - one load per parameter, new targets for the smoothed values
+    void beginBlock() noexcept;
+
+    // audio thread - the next numSamples of each smoothed value, for the chunk about to be rendered
+    void fillFeedbackGains (float* dest, int numSamples) noexcept;
+    void fillOffsetRatios (float* dest, int numSamples) noexcept;
+    void fillDetunes (float* dest, int numSamples) noexcept;
+    void fillOutputGains (float* dest, int numSamples) noexcept;
+
+    // audio thread - true while the output gain ramp is moving, otherwise getOutputGain() holds for the whole block
+    bool isOutputGainSmoothing() const noexcept     { return outputGain.isSmoothing(); }
+    float getOutputGain() const noexcept            { return outputGain.getTargetValue(); }
+
+    // block-constant settings, as of the last beginBlock()
+    bool isPolyphonic() const noexcept              { return polyphonic; }
+    bool isIndependent() const noexcept             { return independent; }
+    bool isLookAhead() const noexcept               { return lookAhead; }
+
+    // the analysis parameters, for PitchAnalyser::prepare()
+    PitchAnalyser::Parameters getAnalyserParameters() const noexcept;
+
+    // constants
+    static constexpr auto semitoneConstant = 1.05945;
+    static constexpr auto gainRampSeconds = 0.005;      /* feedback and output gain */
+    static constexpr auto pitchRampSeconds = 0.02;      /* offset and detune - long enough that a jump glides */
+
+private:
+    //==============================================================================
+    std::atomic<float>* gainParameter;
+    std::atomic<float>* feedbackParameter;
+    std::atomic<float>* offsetParameter;
+    std::atomic<float>* detuneParameter;
+    std::atomic<float>* voicesParameter;
+    std::atomic<float>* channelModeParameter;
+    std::atomic<float>* lookAheadParameter;
+    PitchAnalyser::Parameters analyserParameters;
+
+    juce::LinearSmoothedValue<float> feedbackGain { 0.0f };
+    juce::LinearSmoothedValue<float> outputGain { 1.0f };
+    juce::LinearSmoothedValue<float> detune { 0.0f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> offsetRatio { 1.0f };
+    float lastOffset = -1.0f;
+
+    bool polyphonic = false;
+    bool independent = false;
+    bool lookAhead = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterEngine)
+};
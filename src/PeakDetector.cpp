@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    Spectral peak search restricted to the guitar band, refined to sub-bin
+    accuracy with quadratic interpolation on the log magnitudes. The single
+    pitch decision goes through a harmonic product spectrum, so a loud
+    overtone isn't mistaken for the fundamental.
+
+  ==============================================================================
+*/
+
+#include "PeakDetector.h"
+
+//==============================================================================
+void PeakDetector::prepare (double sampleRate, int fftSize, float lowestFreq, float highestFreq)
+{
+    binWidth = static_cast<float> (sampleRate / fftSize);
+
+    // keep one neighbour on each side inside the spectrum for the interpolation
+    firstBin = juce::jmax (1, static_cast<int> (std::floor (lowestFreq / binWidth)));
+    const auto lastBin = juce::jmin (fftSize / 2 - 2, static_cast<int> (std::ceil (highestFreq / binWidth)));
+    numBins = juce::jmax (0, lastBin - firstBin + 1);
+
+    // every harmonic of every bin in the band has to land inside the spectrum
+    numSpectrumBins = fftSize / 2;
+    numHarmonics = juce::jlimit (1, hpsHarmonics, (numSpectrumBins - 1) / juce::jmax (1, lastBin + 1));
+    product.assign ((size_t) numBins, 0.0f);
+    downsampled.assign ((size_t) numBins, 0.0f);
+}
+
+PeakDetector::Peak PeakDetector::findPeak (const float* magnitudes) const noexcept
+{
+    if (numBins == 0)
+        return {};
+
+    // vectorised max-reduction over the band only, then a cheap scan back for its position
+    const auto* band = magnitudes + firstBin;
+    const auto max = juce::FloatVectorOperations::findMaximum (band, numBins);
+    const auto bin = firstBin + static_cast<int> (std::find (band, band + numBins, max) - band);
+
+    return { refineBin (magnitudes, bin) * binWidth, max };
+}
+
+PeakDetector::Peak PeakDetector::findFundamental (const float* magnitudes) noexcept
+{
+    const auto strongest = findPeak (magnitudes);
+    if (strongest.magnitude <= 0.0f)
+        return strongest;
+
+    // downsample by h, keeping the largest bin within half a harmonic spacing so a fundamental between
+    // bins still lines up with its overtones, then multiply in - the multiply is the vectorised part
+    juce::FloatVectorOperations::copy (product.data(), magnitudes + firstBin, numBins);
+
+    for (auto h = 2; h <= numHarmonics; h++)
+    {
+        const auto reach = h / 2;
+        for (auto i = 0; i < numBins; i++)
+        {
+            const auto centre = (firstBin + i) * h;
+            const auto* neighbours = magnitudes + centre - reach;
+            downsampled[(size_t) i] = *std::max_element (neighbours, neighbours + 2 * reach + 1);
+        }
+
+        juce::FloatVectorOperations::multiply (product.data(), downsampled.data(), numBins);
+    }
+
+    const auto max = juce::FloatVectorOperations::findMaximum (product.data(), numBins);
+    const auto bin = firstBin + static_cast<int> (std::find (product.begin(), product.end(), max) - product.begin());
+    const auto coarse = static_cast<float> (bin) * binWidth;
+
+    // the product's bin is only good to half a bin, the strongest peak is interpolated - if it's a
+    // harmonic of the winner, dividing it down keeps that accuracy
+    const auto harmonic = std::round (strongest.frequency / coarse);
+    if (harmonic >= 1.0f && harmonic <= static_cast<float> (numHarmonics)
+         && std::abs (strongest.frequency / harmonic - coarse) <= binWidth)
+        return { strongest.frequency / harmonic, strongest.magnitude };
+
+    // no sensible relation (inharmonic input) - refine the winner's own neighbourhood instead
+    auto peakBin = bin;
+    if (bin > firstBin && magnitudes[bin - 1] > magnitudes[peakBin])                 peakBin = bin - 1;
+    if (bin < firstBin + numBins - 1 && magnitudes[bin + 1] > magnitudes[peakBin])   peakBin = bin + 1;
+
+    return { refineBin (magnitudes, peakBin) * binWidth, strongest.magnitude };
+}
+
+int PeakDetector::findNotes (const float* magnitudes, float threshold, Peak* notes, int maxNotes) const noexcept
+{
+    // strongest local maxima in the band, kept sorted by magnitude
+    std::array<Peak, maxCandidates> candidates;
+    auto numCandidates = 0;
+
+    for (auto bin = firstBin; bin < firstBin + numBins; bin++)
+    {
+        const auto magnitude = magnitudes[bin];
+        if (magnitude <= threshold || magnitude <= magnitudes[bin - 1] || magnitude < magnitudes[bin + 1])
+            continue;
+
+        if (numCandidates == maxCandidates && magnitude <= candidates[(size_t) (numCandidates - 1)].magnitude)
+            continue;
+
+        auto slot = juce::jmin (numCandidates, maxCandidates - 1);
+        while (slot > 0 && candidates[(size_t) (slot - 1)].magnitude < magnitude)
+        {
+            candidates[(size_t) slot] = candidates[(size_t) (slot - 1)];
+            slot--;
+        }
+        candidates[(size_t) slot] = { refineBin (magnitudes, bin) * binWidth, magnitude };
+        numCandidates = juce::jmin (numCandidates + 1, maxCandidates);
+    }
+
+    if (numCandidates == 0)
+        return 0;
+
+    const auto floor = candidates[0].magnitude * minRelativeMagnitude;
+    while (numCandidates > 0 && candidates[(size_t) (numCandidates - 1)].magnitude < floor)
+        numCandidates--;
+
+    // harmonic grouping from the bottom up: anything close to an integer multiple of an accepted note is an overtone
+    std::sort (candidates.begin(), candidates.begin() + numCandidates,
+               [] (const Peak& a, const Peak& b) { return a.frequency < b.frequency; });
+
+    std::array<Peak, maxCandidates> accepted;
+    auto numAccepted = 0;
+
+    for (auto c = 0; c < numCandidates; c++)
+    {
+        const auto& candidate = candidates[(size_t) c];
+        auto isOvertone = false;
+
+        for (auto a = 0; a < numAccepted && ! isOvertone; a++)
+        {
+            const auto ratio = candidate.frequency / accepted[(size_t) a].frequency;
+            const auto harmonic = std::round (ratio);
+
+            if (harmonic >= 2.0f && harmonic <= maxHarmonic
+                 && std::abs (1200.0f * std::log2 (ratio / harmonic)) < harmonicToleranceCents)
+            {
+                accepted[(size_t) a].magnitude += candidate.magnitude;
+                isOvertone = true;
+            }
+        }
+
+        if (! isOvertone)
+            accepted[(size_t) numAccepted++] = candidate;
+    }
+
+    std::sort (accepted.begin(), accepted.begin() + numAccepted,
+               [] (const Peak& a, const Peak& b) { return a.magnitude > b.magnitude; });
+
+    const auto numNotes = juce::jmin (numAccepted, maxNotes);
+    std::copy (accepted.begin(), accepted.begin() + numNotes, notes);
+    return numNotes;
+}
+
+// quadratic fit through the peak and its neighbours - on log magnitudes a hann
+// main lobe is close to a parabola, which keeps the bias well under a cent
+float PeakDetector::refineBin (const float* magnitudes, int bin) const noexcept
+{
+    constexpr auto floor = 1.0e-12f;
+    const auto left   = std::log (juce::jmax (floor, magnitudes[bin - 1]));
+    const auto centre = std::log (juce::jmax (floor, magnitudes[bin]));
+    const auto right  = std::log (juce::jmax (floor, magnitudes[bin + 1]));
+
+    const auto denominator = left - 2.0f * centre + right;
+    if (denominator >= 0.0f)
+        return static_cast<float> (bin);
+
+    const auto offset = 0.5f * (left - right) / denominator;
+    return static_cast<float> (bin) + juce::jlimit (-0.5f, 0.5f, offset);
+}
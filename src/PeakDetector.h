@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Spectral peak search restricted to the guitar band, refined to sub-bin
+    accuracy with quadratic interpolation on the log magnitudes. The single
+    pitch decision goes through a harmonic product spectrum, so a loud
+    overtone isn't mistaken for the fundamental.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class PeakDetector
+{
+public:
+    //==============================================================================
+    struct Peak
+    {
+        float frequency = 0.0f;
+        float magnitude = 0.0f;
+    };
+
+    PeakDetector() = default;
+
+    // message thread - precomputes the bin range that covers [lowestFreq, highestFreq] and sizes the HPS buffers
+    void prepare (double sampleRate, int fftSize, float lowestFreq, float highestFreq);
+
+    // magnitudes is the output of performFrequencyOnlyForwardTransform
+    Peak findPeak (const float* magnitudes) const noexcept;
+
+    // the fundamental the strongest peak belongs to: the harmonic product spectrum over the band picks
+    // the note, the strongest peak divided by its harmonic number gives the exact frequency.
+    // magnitude is still that of the strongest peak, so thresholds mean the same as for findPeak()
+    Peak findFundamental (const float* magnitudes) noexcept;
+
+    // up to maxNotes separate notes above threshold, strongest first. Peaks that sit on a
+    // harmonic of a lower accepted peak are folded into it rather than counted as notes
+    int findNotes (const float* magnitudes, float threshold, Peak* notes, int maxNotes) const noexcept;
+
+    static constexpr auto maxCandidates = 16;
+    static constexpr auto maxHarmonic = 8;
+    static constexpr auto harmonicToleranceCents = 35.0f;
+    static constexpr auto minRelativeMagnitude = 0.1f;  /* candidates more than 20 dB under the strongest are ignored */
+    static constexpr auto hpsHarmonics = 4;       /* 4 x 1200 Hz still fits under the nyquist of an 11 kHz analysis rate */
+
+    int getFirstBin() const noexcept        { return firstBin; }
+    int getNumBins() const noexcept         { return numBins; }
+    float getBinWidth() const noexcept      { return binWidth; }
+
+private:
+    //==============================================================================
+    float refineBin (const float* magnitudes, int bin) const noexcept;
+
+    int firstBin = 1;
+    int numBins = 0;
+    float binWidth = 1.0f;
+
+    // harmonic product spectrum over the band, and the spectrum downsampled by one harmonic number at a time
+    std::vector<float> product, downsampled;
+    int numHarmonics = 1;
+    int numSpectrumBins = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakDetector)
+};
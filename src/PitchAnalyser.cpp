@@ -0,0 +1,604 @@
+/*
+  ==============================================================================
+
+    Pitch analysis for one channel. The audio thread only pushes samples into
+    a wait-free ring buffer; a thread of the shared AnalysisService drains it,
+    runs the detectors and publishes the results through atomics.
+
+  ==============================================================================
+*/
+
+#include "PitchAnalyser.h"
+
+//==============================================================================
+PitchAnalyser::SharedTables::SharedTables()
+{
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (windowTable.data(), fftSize, juce::dsp::WindowingFunction<float>::hann);
+
+    const auto spacing = juce::MathConstants<double>::twoPi * holdNeighbourBins / fftSize;
+    for (size_t n = 0; n < fftSize; n++)
+    {
+        neighbourCos[n] = static_cast<float> (std::cos (spacing * static_cast<double> (n)));
+        neighbourSin[n] = static_cast<float> (std::sin (spacing * static_cast<double> (n)));
+    }
+}
+
+//==============================================================================
+void PitchAnalyser::prepare (const Parameters& parameters, double sampleRate, int samplesPerBlock)
+{
+    params = parameters;
+    jassert (params.tolerance != nullptr && params.hopSize != nullptr && params.detector != nullptr && params.voices != nullptr
+              && params.hold != nullptr);
+
+    // offline bounces and high-rate hosts can hand over blocks longer than ringSeconds
+    const auto ringSize = juce::nextPowerOfTwo (juce::jmax (juce::roundToInt (sampleRate * ringSeconds), 2 * samplesPerBlock));
+    ringBuffer.assign ((size_t) ringSize, 0.0f);
+    ringFifo.setTotalSize (ringSize);
+
+    decimator.prepare (sampleRate, minAnalysisRate, highestGuitarFreq);
+    analysisSampleRate = decimator.getOutputSampleRate();
+    peakDetector.prepare (analysisSampleRate, fftSize, lowestGuitarFreq, highestGuitarFreq);
+    yinDetector.prepare (analysisSampleRate, lowestGuitarFreq, highestGuitarFreq);
+    jassert (yinDetector.getFrameSize() <= fftSize);
+    resonatorBank.prepare (analysisSampleRate, lowestGuitarFreq, highestGuitarFreq);
+    resonatorsRunning = false;
+    onsetRequests.store (0);
+    answeredOnset.store (0);
+    handledOnset = 0;
+    recoveringFromOnset = false;
+    holding = false;
+    consistentFrames = 0;
+    holdBasisFrequency = 0.0f;
+    framesAnalysed.store (0);
+    framesSkipped.store (0);
+    ringFifo.reset();
+    droppedSamples.store (0);
+    history.fill (0.0f);
+    historyIndex = 0;
+    historyFill = 0;
+    samplesSinceFrame = 0;
+    latestFrequency.store (0.0f);
+}
+
+void PitchAnalyser::pushSamples (const float* samples, int numSamples) noexcept
+{
+    const auto numToWrite = juce::jmin (numSamples, ringFifo.getFreeSpace());
+    if (numToWrite < numSamples)
+        droppedSamples.store (droppedSamples.load (std::memory_order_relaxed) + (juce::uint32) (numSamples - numToWrite), std::memory_order_relaxed);
+
+    const auto scope = ringFifo.write (numToWrite);
+
+    if (scope.blockSize1 > 0)
+        std::copy (samples, samples + scope.blockSize1, ringBuffer.begin() + scope.startIndex1);
+
+    if (scope.blockSize2 > 0)
+        std::copy (samples + scope.blockSize1, samples + scope.blockSize1 + scope.blockSize2, ringBuffer.begin() + scope.startIndex2);
+}
+
+juce::uint32 PitchAnalyser::notifyOnset() noexcept
+{
+    // single writer, so no read-modify-write needed
+    const auto onset = onsetRequests.load (std::memory_order_relaxed) + 1;
+    onsetRequests.store (onset, std::memory_order_release);
+    return onset;
+}
+
+bool PitchAnalyser::hasEstimateSince (juce::uint32 onset) const noexcept
+{
+    return static_cast<juce::int32> (answeredOnset.load (std::memory_order_acquire) - onset) >= 0;
+}
+
+bool PitchAnalyser::getLatestNotes (NoteSet& dest, juce::uint32& lastSequence) const noexcept
+{
+    const auto sequence = noteSequence.load (std::memory_order_acquire);
+    if (sequence == lastSequence || (sequence & 1) != 0)
+        return false;
+
+    NoteSet notes;
+    notes.numNotes = juce::jlimit (0, maxNotes, numPublishedNotes.load (std::memory_order_relaxed));
+    for (auto i = 0; i < notes.numNotes; i++)
+        notes.frequencies[(size_t) i] = noteFrequencies[(size_t) i].load (std::memory_order_relaxed);
+
+    std::atomic_thread_fence (std::memory_order_acquire);
+    if (noteSequence.load (std::memory_order_relaxed) != sequence)
+        return false;
+
+    dest = notes;
+    lastSequence = sequence;
+    return true;
+}
+
+PitchAnalyser::HoldStats PitchAnalyser::getHoldStats() const noexcept
+{
+    return { framesAnalysed.load (std::memory_order_relaxed), framesSkipped.load (std::memory_order_relaxed) };
+}
+
+int PitchAnalyser::getLatencySamples() const noexcept
+{
+    // no frame here - the slowest resonator's time constant plays the part of half a window
+    if (usesResonators())
+        return decimator.getLatencySamples() + (resonatorBank.getSettleSamples() + resonatorInterval) * decimator.getFactor();
+
+    return decimator.getLatencySamples() + (getFrameSize() / 2 + getHopSize()) * decimator.getFactor();
+}
+
+int PitchAnalyser::getMaxLatencySamples() const noexcept
+{
+    // a full frame with no overlap, unless the resonators take longer to settle than that
+    const auto frameLatency = fftSize / 2 + fftSize;
+    const auto resonatorLatency = resonatorBank.getSettleSamples() + resonatorInterval;
+    return decimator.getLatencySamples() + juce::jmax (frameLatency, resonatorLatency) * decimator.getFactor();
+}
+
+int PitchAnalyser::getHopSize() const noexcept
+{
+    const auto choice = juce::jlimit (0, numHopSizes - 1, static_cast<int> (params.hopSize->load (std::memory_order_relaxed)));
+    return juce::jmax (1, getFrameSize() >> choice);
+}
+
+int PitchAnalyser::getFrameSize() const noexcept
+{
+    // multi-voice analysis is always spectral
+    return getDetector() == Detector::yin && getNumVoices() == 1 ? yinDetector.getFrameSize() : fftSize;
+}
+
+PitchAnalyser::Detector PitchAnalyser::getDetector() const noexcept
+{
+    switch (static_cast<int> (params.detector->load (std::memory_order_relaxed)))
+    {
+        case 1:     return Detector::yin;
+        case 2:     return Detector::resonators;
+        default:    return Detector::fft;
+    }
+}
+
+int PitchAnalyser::getNumVoices() const noexcept
+{
+    return juce::jlimit (1, maxNotes, static_cast<int> (params.voices->load (std::memory_order_relaxed)));
+}
+
+//==============================================================================
+// drains everything the audio thread has written since the last pass
+void PitchAnalyser::processPendingSamples (Scratch& scratchToUse)
+{
+    scratch = &scratchToUse;
+
+    const auto onset = onsetRequests.load (std::memory_order_acquire);
+    if (onset != handledOnset)
+    {
+        handledOnset = onset;
+        restartAfterOnset();
+    }
+
+    const auto scope = ringFifo.read (ringFifo.getNumReady());
+
+    decimateIntoHistory (ringBuffer.data() + scope.startIndex1, scope.blockSize1);
+    decimateIntoHistory (ringBuffer.data() + scope.startIndex2, scope.blockSize2);
+
+    scratch = nullptr;
+}
+
+void PitchAnalyser::decimateIntoHistory (const float* samples, int numSamples) noexcept
+{
+    for (auto start = 0; start < numSamples; start += decimationBlockSize)
+    {
+        const auto num = juce::jmin (decimationBlockSize, numSamples - start);
+        const auto numDecimated = decimator.process (samples + start, num, decimatedBlock.data());
+
+        if (usesResonators())
+            runResonators (decimatedBlock.data(), numDecimated);
+        else
+            resonatorsRunning = false;
+
+        // the history keeps filling either way, so switching back to a framed detector needs no warm-up
+        pushIntoHistory (decimatedBlock.data(), numDecimated);
+    }
+}
+
+// appends decimated samples to the circular history and runs a frame every hop once a full window is available
+void PitchAnalyser::pushIntoHistory (const float* samples, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const auto hopSize = getHopSize();
+        const auto toFrame = juce::jmax (1, hopSize - samplesSinceFrame);
+        const auto toWrap = fftSize - historyIndex;
+        const auto toQuickEstimate = recoveringFromOnset ? samplesUntilQuickEstimate : fftSize;
+        const auto num = juce::jmin (juce::jmin (numSamples, toFrame), juce::jmin (toWrap, toQuickEstimate));
+
+        std::copy (samples, samples + num, history.begin() + historyIndex);
+        historyIndex = (historyIndex + num) & (fftSize - 1);
+        historyFill = juce::jmin (fftSize, historyFill + num);
+        samplesSinceFrame += num;
+        samples += num;
+        numSamples -= num;
+
+        // right after an attack: short windows until the steady detector has caught up
+        if (recoveringFromOnset)
+        {
+            samplesSinceOnset += num;
+            samplesUntilQuickEstimate -= num;
+
+            if (samplesUntilQuickEstimate == 0)
+            {
+                samplesUntilQuickEstimate = juce::jmax (1, yinDetector.getFrameSize() / quickEstimateDivisions);
+                const auto tempFrequency = getYinFrequency();
+
+                if (tempFrequency > lowestGuitarFreq && tempFrequency < highestGuitarFreq)
+                    publishFrequency (tempFrequency);
+
+                recoveringFromOnset = ! isSettledAfterOnset();
+            }
+        }
+
+        // condition for a frame being ready (a full frame and a whole hop since the last one)
+        if (samplesSinceFrame >= hopSize && historyFill >= getFrameSize() && ! usesResonators())
+        {
+            samplesSinceFrame = 0;
+            performFrame();
+        }
+    }
+}
+
+void PitchAnalyser::performFrame() noexcept
+{
+    // a held note only needs checking - nothing is published, so the current pitch carries on
+    if (holding)
+    {
+        if (isHoldEnabled() && heldFrames < maxHeldFrames && verifyHeldPitch())
+        {
+            heldFrames++;
+            framesSkipped.store (framesSkipped.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            publishSpectrum (false);
+            return;
+        }
+
+        // a refresh keeps the agreement count, so an unchanged note goes straight back into the hold
+        if (heldFrames < maxHeldFrames)
+            consistentFrames = 0;
+
+        holding = false;
+    }
+
+    FEEDBACK_PROFILE_WRITER_SCOPE (profiler, analysisFrame, scratch->profilerWriter);
+    framesAnalysed.store (framesAnalysed.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (getNumVoices() > 1)
+    {
+        performTransform();
+        publishNotes();
+        publishSpectrum (true);
+        consistentFrames = 0;
+        return;
+    }
+
+    const auto spectral = getDetector() != Detector::yin;
+    const auto tempFrequency = spectral ? getFundamentalFrequency() : getYinFrequency();
+
+    // only publish pitches worth sustaining, otherwise the last one is held
+    if (tempFrequency > lowestGuitarFreq && tempFrequency < highestGuitarFreq)
+        publishFrequency (tempFrequency);
+
+    updateHold (tempFrequency);
+    publishSpectrum (spectral);
+}
+
+// windowed read straight out of the circular history, oldest sample first -
+// two contiguous runs, no intermediate copy and no clearing of the scratch half
+void PitchAnalyser::windowHistory (float* dest) const noexcept
+{
+    const auto& windowTable = tables->windowTable;
+    const auto firstRun = fftSize - historyIndex;
+    juce::FloatVectorOperations::multiply (dest, history.data() + historyIndex, windowTable.data(), firstRun);
+    juce::FloatVectorOperations::multiply (dest + firstRun, history.data(), windowTable.data() + firstRun, historyIndex);
+}
+
+void PitchAnalyser::performTransform() noexcept
+{
+    auto* fftData = scratch->fftData.data();
+    windowHistory (fftData);
+    scratch->forwardFFT.performFrequencyOnlyForwardTransform (fftData);
+}
+
+// tolerance determines how easy it is to generate feedback, scaled so it means the same at any frame size
+float PitchAnalyser::getMagnitudeThreshold() const noexcept
+{
+    return params.tolerance->load() * toleranceConstant * (static_cast<float> (fftSize) / toleranceReferenceSize);
+}
+
+float PitchAnalyser::getFundamentalFrequency()
+{
+    performTransform();
+
+    FEEDBACK_PROFILE_WRITER_SCOPE (profiler, peakSearch, scratch->profilerWriter);
+    const auto peak = peakDetector.findFundamental (scratch->fftData.data());
+
+    if (peak.magnitude > getMagnitudeThreshold())
+        return peak.frequency;
+
+    return 0;
+}
+
+// like the single pitch, an empty frame publishes nothing so the current notes are sustained
+void PitchAnalyser::publishNotes() noexcept
+{
+    FEEDBACK_PROFILE_WRITER_SCOPE (profiler, peakSearch, scratch->profilerWriter);
+
+    std::array<PeakDetector::Peak, maxNotes> notes;
+    auto numNotes = peakDetector.findNotes (scratch->fftData.data(), getMagnitudeThreshold(), notes.data(), getNumVoices());
+
+    // the band edges are whole bins, trim anything that interpolated just outside the guitar range
+    numNotes = static_cast<int> (std::remove_if (notes.begin(), notes.begin() + numNotes, [] (const PeakDetector::Peak& note)
+                                                 { return note.frequency <= lowestGuitarFreq || note.frequency >= highestGuitarFreq; })
+                                 - notes.begin());
+
+    if (numNotes == 0)
+        return;
+
+    const auto sequence = noteSequence.load (std::memory_order_relaxed);
+    noteSequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    for (auto i = 0; i < numNotes; i++)
+        noteFrequencies[(size_t) i].store (notes[(size_t) i].frequency, std::memory_order_relaxed);
+    numPublishedNotes.store (numNotes, std::memory_order_relaxed);
+
+    noteSequence.store (sequence + 2, std::memory_order_release);
+
+    // the strongest note doubles as the single pitch, so switching back to one voice is seamless
+    publishFrequency (notes[0].frequency);
+}
+
+float PitchAnalyser::getYinFrequency()
+{
+    // the most recent frame of the history, oldest sample first
+    const auto frameSize = yinDetector.getFrameSize();
+    const auto start = (historyIndex - frameSize) & (fftSize - 1);
+    const auto firstRun = juce::jmin (frameSize, fftSize - start);
+    auto& yinFrame = scratch->yinFrame;
+    std::copy (history.begin() + start, history.begin() + start + firstRun, yinFrame.begin());
+    std::copy (history.begin(), history.begin() + (frameSize - firstRun), yinFrame.begin() + firstRun);
+
+    // tolerance maps onto how periodic the frame has to be: 0 is lenient, 1 never triggers
+    const auto maxAllowed = maxAperiodicity * (1.0f - params.tolerance->load());
+    const auto estimate = yinDetector.process (yinFrame.data());
+
+    if (estimate.aperiodicity < maxAllowed)
+        return estimate.frequency;
+
+    return 0;
+}
+
+//==============================================================================
+// multi-voice analysis stays spectral, the bank only tracks a single pitch
+bool PitchAnalyser::usesResonators() const noexcept
+{
+    return getDetector() == Detector::resonators && getNumVoices() == 1;
+}
+
+void PitchAnalyser::runResonators (const float* samples, int numSamples) noexcept
+{
+    if (! resonatorsRunning)
+    {
+        resonatorBank.reset();
+        resonatorsRunning = true;
+    }
+
+    // a hann-windowed sine of amplitude A peaks at A * fftSize / 4, the bank reports A itself
+    const auto threshold = getMagnitudeThreshold() * 4.0f / static_cast<float> (fftSize);
+
+    for (auto start = 0; start < numSamples; start += resonatorInterval)
+    {
+        const auto num = juce::jmin (resonatorInterval, numSamples - start);
+        {
+            FEEDBACK_PROFILE_WRITER_SCOPE (profiler, analysisFrame, scratch->profilerWriter);
+            resonatorBank.process (samples + start, num);
+        }
+
+        FEEDBACK_PROFILE_WRITER_SCOPE (profiler, peakSearch, scratch->profilerWriter);
+        const auto peak = resonatorBank.findPeak();
+
+        // while the bank is still re-converging after an onset the quick YIN estimates speak for it
+        if (! recoveringFromOnset && peak.magnitude > threshold && peak.frequency > lowestGuitarFreq && peak.frequency < highestGuitarFreq)
+            publishFrequency (peak.frequency);
+    }
+
+    publishSpectrum (false);
+}
+
+//==============================================================================
+void PitchAnalyser::publishFrequency (float frequency) noexcept
+{
+    latestFrequency.store (frequency, std::memory_order_relaxed);
+    answeredOnset.store (handledOnset, std::memory_order_release);
+}
+
+// the display gets the frame's magnitudes when there are any, otherwise just the pitch
+void PitchAnalyser::publishSpectrum (bool hasSpectrum) noexcept
+{
+    static_assert (SpectrumFeed::maxBins >= fftSize / 2 + 1, "the feed has to hold the whole positive half");
+
+    if (spectrumFeed == nullptr || ! spectrumFeed->isWanted())
+        return;
+
+    auto& snapshot = spectrumFeed->getWriteBuffer();
+    snapshot.numBins = hasSpectrum ? fftSize / 2 + 1 : 0;
+    if (hasSpectrum)
+        std::copy (scratch->fftData.begin(), scratch->fftData.begin() + snapshot.numBins, snapshot.magnitudes.begin());
+
+    // a hann-windowed sine of amplitude A peaks at A * fftSize / 4
+    snapshot.binWidth = static_cast<float> (analysisSampleRate / fftSize);
+    snapshot.magnitudeScale = 4.0f / static_cast<float> (fftSize);
+    snapshot.threshold = getMagnitudeThreshold();
+    snapshot.frequency = getLatestFrequency();
+    snapshot.held = holding;
+
+    spectrumFeed->publish();
+}
+
+// the old note's samples would only smear the new estimate - start the windows over
+void PitchAnalyser::restartAfterOnset() noexcept
+{
+    historyFill = 0;
+    samplesSinceFrame = 0;
+    resonatorsRunning = false;
+    samplesSinceOnset = 0;
+    samplesUntilQuickEstimate = yinDetector.getFrameSize();
+    recoveringFromOnset = true;
+    holding = false;
+    consistentFrames = 0;
+}
+
+bool PitchAnalyser::isSettledAfterOnset() const noexcept
+{
+    const auto settleSamples = usesResonators() ? resonatorBank.getSettleSamples() : getFrameSize();
+    return samplesSinceOnset >= settleSamples;
+}
+
+//==============================================================================
+bool PitchAnalyser::isHoldEnabled() const noexcept
+{
+    return params.hold->load (std::memory_order_relaxed) >= 0.5f;
+}
+
+// counts agreeing estimates, and once there are enough drops the frames to verification
+void PitchAnalyser::updateHold (float frequency) noexcept
+{
+    if (! isHoldEnabled() || frequency <= lowestGuitarFreq || frequency >= highestGuitarFreq)
+    {
+        consistentFrames = 0;
+        return;
+    }
+
+    const auto agrees = consistentFrames > 0 && std::abs (1200.0f * std::log2 (frequency / lastEstimate)) < holdToleranceCents;
+    consistentFrames = agrees ? consistentFrames + 1 : 1;
+    lastEstimate = frequency;
+
+    // the check always looks at a whole fftSize window, which only a full history has
+    if (consistentFrames < holdAfterFrames || historyFill < fftSize)
+        return;
+
+    heldFrequency = frequency;
+    buildHoldBasis();
+    const auto measurement = measureHeldPitch();
+    if (measurement.energy <= 0.0f)
+        return;
+
+    heldTonalFraction = measurement.centre / measurement.energy;
+    heldEnergy = measurement.energy;
+    heldPhase = measurement.phase;
+    heldFrames = 0;
+    holding = true;
+}
+
+// still the same note if nothing has crept up next to it, it still carries as much of the
+// energy as when the hold started, the level hasn't jumped and the pitch hasn't bent
+bool PitchAnalyser::verifyHeldPitch() noexcept
+{
+    FEEDBACK_PROFILE_WRITER_SCOPE (profiler, holdCheck, scratch->profilerWriter);
+
+    const auto measurement = measureHeldPitch();
+    if (measurement.energy <= 0.0f
+         || measurement.neighbour > maxNeighbourPower * measurement.centre
+         || measurement.centre < minTonalFraction * heldTonalFraction * measurement.energy
+         || measurement.energy > maxEnergyRise * heldEnergy)
+        return false;
+
+    // over one hop the held pitch's phase advances by omega * hop - whatever is left over is the bend.
+    // Only unambiguous within half a cycle per hop, past that the neighbour check has already failed
+    const auto hopSize = getHopSize();
+    const auto expected = juce::MathConstants<double>::twoPi * heldFrequency * hopSize / analysisSampleRate;
+    const auto deviation = std::remainder (measurement.phase - heldPhase - expected, juce::MathConstants<double>::twoPi);
+    const auto drift = deviation / (juce::MathConstants<double>::twoPi * hopSize) * analysisSampleRate;
+
+    if (heldFrequency + drift <= 0.0 || std::abs (1200.0 * std::log2 ((heldFrequency + drift) / heldFrequency)) > holdToleranceCents)
+        return false;
+
+    // notes decay while held, so a rise is measured from the quietest point
+    heldEnergy = juce::jmin (heldEnergy, measurement.energy);
+    heldPhase = measurement.phase;
+    return true;
+}
+
+// the probes sit on the held pitch and on the hann window's first nulls either side of it
+void PitchAnalyser::buildHoldBasis() noexcept
+{
+    if (heldFrequency == holdBasisFrequency)
+        return;
+
+    holdBasisFrequency = heldFrequency;
+
+    // the held pitch: sixteen phasors in double, each stepping sixteen samples at a time -
+    // independent chains the compiler can overlap, and only 64 rotations of rounding in any of them
+    constexpr auto numChains = 16;
+    const auto omega = juce::MathConstants<double>::twoPi * heldFrequency / analysisSampleRate;
+    const auto stepRe = std::cos (omega * numChains);
+    const auto stepIm = std::sin (omega * numChains);
+
+    std::array<double, numChains> re, im;
+    for (size_t c = 0; c < numChains; c++)
+    {
+        re[c] = std::cos (omega * static_cast<double> (c));
+        im[c] = std::sin (omega * static_cast<double> (c));
+    }
+
+    auto& centreCos = holdCos[1];
+    auto& centreSin = holdSin[1];
+
+    for (size_t start = 0; start < fftSize; start += numChains)
+    {
+        for (size_t c = 0; c < numChains; c++)
+        {
+            centreCos[start + c] = static_cast<float> (re[c]);
+            centreSin[start + c] = static_cast<float> (im[c]);
+
+            const auto nextRe = re[c] * stepRe - im[c] * stepIm;
+            im[c] = re[c] * stepIm + im[c] * stepRe;
+            re[c] = nextRe;
+        }
+    }
+
+    // the neighbours are the held pitch rotated a fixed step either way
+    const auto& stepCos = tables->neighbourCos;
+    const auto& stepSin = tables->neighbourSin;
+
+    for (size_t n = 0; n < fftSize; n++)
+    {
+        holdCos[0][n] = centreCos[n] * stepCos[n] + centreSin[n] * stepSin[n];
+        holdSin[0][n] = centreSin[n] * stepCos[n] - centreCos[n] * stepSin[n];
+        holdCos[2][n] = centreCos[n] * stepCos[n] - centreSin[n] * stepSin[n];
+        holdSin[2][n] = centreSin[n] * stepCos[n] + centreCos[n] * stepSin[n];
+    }
+}
+
+// the windowed history's energy and its DFT at the three probes, all in one SIMD pass
+PitchAnalyser::HoldMeasurement PitchAnalyser::measureHeldPitch() const noexcept
+{
+    // the upper half of the FFT buffer - the lower half may still hold this frame's magnitudes for the display
+    auto* windowed = scratch->fftData.data() + fftSize;
+    windowHistory (windowed);
+
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    auto energy = Vec::expand (0.0f);
+    std::array<Vec, numHoldProbes> sumCos, sumSin;
+    sumCos.fill (Vec::expand (0.0f));
+    sumSin.fill (Vec::expand (0.0f));
+
+    for (size_t n = 0; n < fftSize; n += Vec::SIMDNumElements)
+    {
+        const auto x = Vec::fromRawArray (windowed + n);
+        energy += x * x;
+
+        for (size_t k = 0; k < numHoldProbes; k++)
+        {
+            sumCos[k] += x * Vec::fromRawArray (holdCos[k].data() + n);
+            sumSin[k] += x * Vec::fromRawArray (holdSin[k].data() + n);
+        }
+    }
+
+    const auto power = [&] (size_t k) { return sumCos[k].sum() * sumCos[k].sum() + sumSin[k].sum() * sumSin[k].sum(); };
+
+    // X = sum x[n] e^(-j omega n) - a steady note advances it by omega per sample of hop
+    return { energy.sum(), power (1), juce::jmax (power (0), power (2)), std::atan2 (-sumSin[1].sum(), sumCos[1].sum()) };
+}
@@ -0,0 +1,267 @@
+/*
+  ==============================================================================
+
+    Pitch analysis for one channel. The audio thread only pushes samples into
+    a wait-free ring buffer; a thread of the shared AnalysisService drains it,
+    runs the detectors and publishes the results through atomics.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Decimator.h"
+#include "PeakDetector.h"
+#include "YinDetector.h"
+#include "ResonatorBank.h"
+#include "Profiler.h"
+#include "SpectrumFeed.h"
+
+//==============================================================================
+/**
+*/
+class PitchAnalyser
+{
+public:
+    //==============================================================================
+    // raw parameter values, resolved once by the processor
+    struct Parameters
+    {
+        std::atomic<float>* tolerance = nullptr;
+        std::atomic<float>* hopSize = nullptr;
+        std::atomic<float>* detector = nullptr;
+        std::atomic<float>* voices = nullptr;
+        std::atomic<float>* hold = nullptr;
+    };
+
+    enum class Detector
+    {
+        fft = 0,        // spectral peak over a long window
+        yin,            // time-domain YIN over about two periods of the lowest note
+        resonators      // quarter-tone resonator bank, updated every sample with no window to fill
+    };
+
+    PitchAnalyser() = default;
+
+    //==============================================================================
+    // message thread, while no service is draining it - clears all state, picks the decimation factor
+    // and sizes the ring so a whole block always fits, even when it's drained inline after every block
+    void prepare (const Parameters& parameters, double sampleRate, int samplesPerBlock);
+
+   #if FEEDBACK_ENABLE_PROFILING
+    // frames and peak searches are timed into this, null to stop
+    void setProfiler (Profiler* profilerToUse) noexcept   { profiler = profilerToUse; }
+   #endif
+
+    // frames are copied into this while a display is watching it, null to stop
+    void setSpectrumFeed (SpectrumFeed* feedToUse) noexcept { spectrumFeed = feedToUse; }
+
+    // audio thread - wait-free, drops samples if the worker has fallen behind
+    void pushSamples (const float* samples, int numSamples) noexcept;
+
+    // any thread - samples pushSamples() had no room for since prepare()
+    juce::uint32 getNumDroppedSamples() const noexcept  { return droppedSamples.load (std::memory_order_relaxed); }
+
+    // any thread - true if the audio thread has written samples that haven't been drained yet
+    bool hasPendingSamples() const noexcept     { return ringFifo.getNumReady() > 0; }
+
+    struct Scratch;
+
+    // worker thread - drains everything the audio thread has written since the last pass.
+    // Only one thread at a time, but it needn't be the same one each time
+    void processPendingSamples (Scratch& scratchToUse);
+
+    // audio thread - an attack was detected: the worker drops the old history and re-estimates from
+    // short YIN windows until the steady detector has enough new signal. Returns an id for hasEstimateSince()
+    juce::uint32 notifyOnset() noexcept;
+
+    // audio thread - true once getLatestFrequency() reflects signal from after that onset
+    bool hasEstimateSince (juce::uint32 onset) const noexcept;
+
+    // frames that ran a detector, and frames a held note's verification stood in for
+    struct HoldStats
+    {
+        juce::uint32 framesAnalysed = 0;
+        juce::uint32 framesSkipped = 0;
+    };
+
+    // any thread - counts since prepare()
+    HoldStats getHoldStats() const noexcept;
+
+    // last fundamental that passed the tolerance and guitar range checks (0 if none yet)
+    float getLatestFrequency() const noexcept   { return latestFrequency.load (std::memory_order_relaxed); }
+
+    // host samples between an input event and the estimate it shows up in:
+    // decimator delay + half a frame + one hop
+    int getLatencySamples() const noexcept;
+
+    // the largest getLatencySamples() any detector and hop size can give at the prepared rate
+    int getMaxLatencySamples() const noexcept;
+    int getHopSize() const noexcept;
+    int getFrameSize() const noexcept;
+    Detector getDetector() const noexcept;
+    int getNumVoices() const noexcept;
+
+    // constants
+    static constexpr auto fftOrder = 10;          /* ~11 Hz bins at the decimated rate, interpolation does the rest */
+    static constexpr auto fftSize = 1 << fftOrder;
+    static constexpr auto minAnalysisRate = 11000.0;  /* decimate down to no less than this - YIN needs ~9 samples per period at the top */
+    static constexpr auto lowestGuitarFreq = 75;
+    static constexpr auto highestGuitarFreq = 1200;
+    static constexpr auto toleranceConstant = 250;
+    static constexpr auto toleranceReferenceSize = 4096;  /* toleranceConstant was tuned on a 4096 point frame */
+    static constexpr auto numHopSizes = 4;        /* hop = frame size >> choice, so 0% / 50% / 75% / 87.5% overlap */
+    static constexpr auto maxAperiodicity = 0.4f; /* YIN confidence floor at Tolerance 0, Tolerance 1 accepts nothing */
+    static constexpr auto maxNotes = 6;           /* one per string */
+    static constexpr auto resonatorInterval = 32; /* analysis samples between resonator bank estimates, ~3 ms */
+    static constexpr auto quickEstimateDivisions = 4;  /* after an onset, short YIN estimates every quarter of its frame */
+    static constexpr auto holdAfterFrames = 4;    /* consecutive agreeing single-pitch estimates before analysis drops to verification */
+    static constexpr auto holdToleranceCents = 20.0f;
+    static constexpr auto maxHeldFrames = 32;     /* a full frame at least this often while held (~0.75 s at the default hop), so slow drift is still followed */
+    static constexpr auto holdNeighbourBins = 2;  /* verification neighbours sit on the hann window's first nulls */
+    static constexpr auto maxNeighbourPower = 0.25f;   /* a neighbour within 6 dB of the held pitch means it has moved */
+    static constexpr auto minTonalFraction = 0.5f;     /* held pitch's share of the frame energy, relative to when the hold started */
+    static constexpr auto maxEnergyRise = 2.0f;        /* 3 dB over the quietest held frame means something new was played */
+    static constexpr auto ringSeconds = 0.1;      /* host audio the ring holds before samples are dropped (at least two blocks), rounded up to a power of two */
+
+    // read-only once built, one copy per process shared by every analyser of every instance
+    struct SharedTables
+    {
+        SharedTables();
+
+        std::array<float, fftSize> windowTable;
+
+        // cos and sin of a holdNeighbourBins step at every window position - turns the held pitch's basis into its neighbours'
+        std::array<float, fftSize> neighbourCos, neighbourSin;
+    };
+
+    // working memory for one pass - owned by the thread doing the pass, not by the analyser.
+    // The FFT lives here rather than in the shared tables: JUCE's fallback engine locks inside
+    // perform(), so one plan for the whole pool would put every worker in a queue for it
+    struct Scratch
+    {
+        juce::dsp::FFT forwardFFT { fftOrder };
+        alignas (32) std::array<float, fftSize * 2> fftData;
+        std::array<float, fftSize> yinFrame;
+
+       #if FEEDBACK_ENABLE_PROFILING
+        int profilerWriter = Profiler::audioThreadWriter;  // the owning thread's histograms
+       #endif
+    };
+
+    // notes found by the multi-voice analysis, strongest first
+    struct NoteSet
+    {
+        std::array<float, maxNotes> frequencies {};
+        int numNotes = 0;
+    };
+
+    // audio thread - copies the newest note set if one was published after lastSequence.
+    // Never waits: if the worker is mid-publish it returns false and the caller tries next block
+    bool getLatestNotes (NoteSet& dest, juce::uint32& lastSequence) const noexcept;
+
+private:
+    //==============================================================================
+    void decimateIntoHistory (const float* samples, int numSamples) noexcept;
+    void pushIntoHistory (const float* samples, int numSamples) noexcept;
+    void performFrame() noexcept;
+    void windowHistory (float* dest) const noexcept;
+    void performTransform() noexcept;
+    float getFundamentalFrequency();
+    float getYinFrequency();
+    void publishNotes() noexcept;
+    bool usesResonators() const noexcept;
+    void publishFrequency (float frequency) noexcept;
+    void publishSpectrum (bool hasSpectrum) noexcept;
+    void restartAfterOnset() noexcept;
+    bool isSettledAfterOnset() const noexcept;
+    bool isHoldEnabled() const noexcept;
+    void updateHold (float frequency) noexcept;
+    bool verifyHeldPitch() noexcept;
+    void buildHoldBasis() noexcept;
+
+    // windowed energy of the whole history, and its powers at the held pitch and either side of it
+    struct HoldMeasurement
+    {
+        float energy = 0.0f;
+        float centre = 0.0f;
+        float neighbour = 0.0f;     // the larger of the two
+        float phase = 0.0f;         // of the held pitch's bin, compared hop to hop
+    };
+
+    HoldMeasurement measureHeldPitch() const noexcept;
+    void runResonators (const float* samples, int numSamples) noexcept;
+    float getMagnitudeThreshold() const noexcept;
+
+    // ring buffer between the audio thread (writer) and the worker (reader), at the host rate - sized in prepare()
+    static constexpr auto decimationBlockSize = 1024;
+    juce::AbstractFifo ringFifo { 1 };
+    std::vector<float> ringBuffer;
+    std::atomic<juce::uint32> droppedSamples { 0 };     // only written by the audio thread
+
+    // band-limits and downsamples the ring contents before they reach the history
+    Decimator decimator;
+    std::array<float, decimationBlockSize + 1> decimatedBlock;
+
+    // band-limited, interpolated argmax over the magnitude spectrum
+    PeakDetector peakDetector;
+
+    // alternative short-window detector, fed with the most recent samples of the history
+    YinDetector yinDetector;
+
+    // incremental detector, fed straight from the decimator; reset whenever it is switched back in
+    ResonatorBank resonatorBank;
+    bool resonatorsRunning = false;
+
+    // onset hand-over: the audio thread bumps onsetRequests, the worker answers with the id it has re-estimated for
+    std::atomic<juce::uint32> onsetRequests { 0 };
+    std::atomic<juce::uint32> answeredOnset { 0 };
+    juce::uint32 handledOnset = 0;
+    bool recoveringFromOnset = false;
+    int samplesSinceOnset = 0;
+    int samplesUntilQuickEstimate = 0;
+
+    // hold mode (worker only): once the estimates agree, frames only check the held pitch is still there
+    bool holding = false;
+    int consistentFrames = 0;
+    int heldFrames = 0;
+    float lastEstimate = 0.0f;
+    float heldFrequency = 0.0f;
+    float heldTonalFraction = 0.0f;
+    float heldEnergy = 0.0f;
+    float heldPhase = 0.0f;
+
+    // cos and sin of the held pitch and its two neighbours at every position in the window, so a check is
+    // a handful of dot products with the windowed history. Rebuilt when a hold starts on a different pitch
+    static constexpr auto numHoldProbes = 3;
+    alignas (32) std::array<std::array<float, fftSize>, numHoldProbes> holdCos;
+    alignas (32) std::array<std::array<float, fftSize>, numHoldProbes> holdSin;
+    float holdBasisFrequency = 0.0f;
+    std::atomic<juce::uint32> framesAnalysed { 0 };
+    std::atomic<juce::uint32> framesSkipped { 0 };
+
+    // PRIVATE MEMBER VARIABLES FOR FFT (only touched by the worker)
+    // history is a sliding circular window - historyIndex points at the oldest sample
+    juce::SharedResourcePointer<SharedTables> tables;
+    Scratch* scratch = nullptr;     // only set for the duration of processPendingSamples()
+    std::array<float, fftSize> history;
+    int historyIndex = 0;
+    int historyFill = 0;
+    int samplesSinceFrame = 0;
+
+    Parameters params;
+    std::atomic<float> latestFrequency { 0.0f };
+
+    // multi-voice results, published under a sequence lock (odd while the worker is writing)
+    std::array<std::atomic<float>, maxNotes> noteFrequencies {};
+    std::atomic<int> numPublishedNotes { 0 };
+    std::atomic<juce::uint32> noteSequence { 0 };
+    double analysisSampleRate = 44100.0;
+   #if FEEDBACK_ENABLE_PROFILING
+    Profiler* profiler = nullptr;
+   #endif
+    SpectrumFeed* spectrumFeed = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PitchAnalyser)
+};
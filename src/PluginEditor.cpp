@@ -13,7 +13,13 @@
 FeedbackAudioProcessorEditor::FeedbackAudioProcessorEditor (FeedbackAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p), apvts (audioProcessor.apvts)
 {
-    setSize(600, 300);
+    addAndMakeVisible(spectrumDisplay);
+    setSize(600, sliderAreaHeight + SpectrumDisplay::preferredHeight);
+
+   #if FEEDBACK_ENABLE_PROFILING
+    addAndMakeVisible(profilerPanel);
+    setSize(600, sliderAreaHeight + SpectrumDisplay::preferredHeight + ProfilerPanel::preferredHeight);
+   #endif
 
     // Gain Slider 
     mGainSlider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
@@ -95,11 +101,18 @@ void FeedbackAudioProcessorEditor::paint (juce::Graphics& g)
 void FeedbackAudioProcessorEditor::resized()
 {
     // bounds for components
-    juce::Rectangle<int> sliderBounds (50, getHeight() / 2 - 75, 100, 150);
+    juce::Rectangle<int> sliderBounds (50, sliderAreaHeight / 2 - 75, 100, 150);
     
     mOffsetSlider      .setBounds(sliderBounds);
     mDetuneSlider      .setBounds(sliderBounds.translated(100, 0));
     mToleranceSlider   .setBounds(sliderBounds.translated(200, 0));
     mFeedbackGainSlider.setBounds(sliderBounds.translated(300, 0));
     mGainSlider        .setBounds(sliderBounds.translated(400, 0));
+
+    auto belowSliders = getLocalBounds().withTrimmedTop(sliderAreaHeight);
+    spectrumDisplay.setBounds(belowSliders.removeFromTop(SpectrumDisplay::preferredHeight));
+
+   #if FEEDBACK_ENABLE_PROFILING
+    profilerPanel.setBounds(belowSliders);
+   #endif
 }
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ProfilerPanel.h"
+#include "SpectrumDisplay.h"
 
 //==============================================================================
 /**
@@ -25,6 +27,7 @@ public:
     void resized() override;
 
 private:
+    static constexpr auto sliderAreaHeight = 300;
 
     // sliders and labels 
     juce::Slider mGainSlider;
@@ -47,5 +50,13 @@ private:
     FeedbackAudioProcessor& audioProcessor;
     juce::AudioProcessorValueTreeState& apvts;
 
+    // live spectrum and tuner under the sliders
+    SpectrumDisplay spectrumDisplay { audioProcessor.getSpectrumFeed() };
+
+   #if FEEDBACK_ENABLE_PROFILING
+    // stage timings under the spectrum
+    ProfilerPanel profilerPanel { audioProcessor.getProfiler() };
+   #endif
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeedbackAudioProcessorEditor)
 };
@@ -15,13 +15,11 @@ FeedbackAudioProcessor::FeedbackAudioProcessor()
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::mono(), true)  // mono() vs. stero()
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)  // mono, stereo and quad are all accepted
                       #endif
-                       .withOutput ("Output", juce::AudioChannelSet::mono(), true)
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       ), apvts(*this, nullptr, "Parameters", createParameters()),
-                          forwardFFT(fftOrder),
-                          window(fftSize, juce::dsp::WindowingFunction<float>::hann)
+                       ), apvts(*this, nullptr, "Parameters", createParameters())
                             
 #endif
 {
@@ -29,6 +27,10 @@ FeedbackAudioProcessor::FeedbackAudioProcessor()
 
 FeedbackAudioProcessor::~FeedbackAudioProcessor()
 {
+    stopTimer();
+
+    // the service outlives us if other instances still hold it
+    removeFromAnalysisService();
 }
 
 //==============================================================================
@@ -71,46 +73,136 @@ double FeedbackAudioProcessor::getTailLengthSeconds() const
 
 int FeedbackAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return presetBank.getNumPresets();
 }
 
 int FeedbackAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return presetBank.getCurrentPreset();
 }
 
 void FeedbackAudioProcessor::setCurrentProgram (int index)
 {
+    presetBank.applyPreset(index);
 }
 
 const juce::String FeedbackAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank.getPresetName(index);
 }
 
 void FeedbackAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    presetBank.renamePreset(index, newName);
 }
 
 //==============================================================================
 void FeedbackAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // set initial values for waveTable
+    removeFromAnalysisService();
+
+    // set initial values for the feedback oscillators
     curSampleRate = sampleRate;
-    phase = 0;
-    wtSize = fftSize; 
-    waveTable.initialise([&] (float i) { return sin(juce::MathConstants<double>::twoPi * i / wtSize); }, wtSize);
 
-    // feedback gain & frequency interpolation for avoiding pops and clicks and smoothness
-    feedbackRamp.reset(curSampleRate, 0.005);
-    frequencyRamp.reset(curSampleRate, 0.025);
+    // gain, offset and detune interpolation for avoiding pops, clicks and zippering
+    parameterEngine.prepare(curSampleRate);
+    const auto analyserParameters = parameterEngine.getAnalyserParameters();
+
+    // the mid sum and linked mix are unrolled for the bus width we were prepared with
+    const auto numChannels = juce::jlimit(1, maxChannels, getTotalNumInputChannels());
+    channelKernels = ChannelKernels::forChannels(numChannels);
+
+    for (int ch = 0; ch < maxChannels; ch++)
+    {
+        auto& channel = channels[(size_t) ch];
+        channel.oscillator.prepare(curSampleRate);
+        channel.oscillatorBank.prepare(curSampleRate);
+        channel.frequencyRamp.reset(curSampleRate, 0.025);
+        channel.frequencyRamp.setCurrentAndTargetValue(0.0f);
+        channel.onsetDetector.prepare(curSampleRate);
+        channel.pendingOnset = 0;
+        channel.snapToNextEstimate = false;
+        channel.analyser.prepare(analyserParameters, curSampleRate, samplesPerBlock);
+       #if FEEDBACK_ENABLE_PROFILING
+        channel.analyser.setProfiler(&profiler);
+       #endif
+        channel.analyser.setSpectrumFeed(ch == 0 ? &spectrumFeed : nullptr);
+    }
+
+    // look-ahead delays the dry path by the analysis latency - the history is sized for the longest any setting can need
+    const auto latency = getLookAheadLatency();
+    dryDelay.prepare(numChannels, channels[0].analyser.getMaxLatencySamples(), latency);
+    lookAheadLatency.store(latency, std::memory_order_relaxed);
+    setLatencySamples(latency);
+
+    // offline renders analyse inside processBlock instead, so the output doesn't depend on thread timing -
+    // and nothing else runs either, the latency is fixed for the render and reported above
+    analyseInline = isNonRealtime();
+    if (analyseInline)
+    {
+        stopTimer();
+        if (inlineScratch == nullptr)
+            inlineScratch = std::make_unique<PitchAnalyser::Scratch>();
+        return;
+    }
+
+    // a change of latency is only reported to the host from the message thread
+    startTimerHz(10);
+
+    if (! analysisService.has_value())
+        analysisService.emplace();
+
+    // only channels the bus actually carries need servicing
+    for (int ch = 0; ch < numChannels; ch++)
+        channels[(size_t) ch].analysisSlot = analysisService->get().add(channels[(size_t) ch].analyser);
+
+    numServicedChannels = numChannels;
 }
 
 void FeedbackAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    removeFromAnalysisService();
+}
+
+bool FeedbackAudioProcessor::getDetectedNotes (int channel, PitchAnalyser::NoteSet& dest) const noexcept
+{
+    juce::uint32 sequence = 0;
+    return channels[(size_t) channel].analyser.getLatestNotes(dest, sequence);
+}
+
+int FeedbackAudioProcessor::getLookAheadLatency() const noexcept
+{
+    // hop size and detector can change at any time, and the latency follows them
+    return parameterEngine.isLookAhead() ? channels[0].analyser.getLatencySamples() : 0;
+}
+
+void FeedbackAudioProcessor::timerCallback()
+{
+    const auto latency = lookAheadLatency.load(std::memory_order_relaxed);
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+PitchAnalyser::HoldStats FeedbackAudioProcessor::getHoldStats() const noexcept
+{
+    PitchAnalyser::HoldStats total;
+    for (const auto& channel : channels)
+    {
+        const auto stats = channel.analyser.getHoldStats();
+        total.framesAnalysed += stats.framesAnalysed;
+        total.framesSkipped += stats.framesSkipped;
+    }
+    return total;
+}
+
+juce::int64 FeedbackAudioProcessor::getNumDroppedAnalysisSamples() const noexcept
+{
+    juce::int64 total = 0;
+    for (const auto& channel : channels)
+        total += channel.analyser.getNumDroppedSamples();
+    return total;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -121,7 +213,8 @@ bool FeedbackAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::quadraphonic())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -138,87 +231,195 @@ bool FeedbackAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void FeedbackAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    FEEDBACK_PROFILE_SCOPE(&profiler, processBlock);
     auto totalNumInputChannels  = getTotalNumInputChannels();
 
+    // every parameter is read once here, the rest of the block works from the snapshot
+    parameterEngine.beginBlock();
+
     if (totalNumInputChannels > 0)
     {
-        // get data for mono and feedbackGain (with interpolation)
-        auto* channelData = buffer.getWritePointer(0);
-        feedbackRamp.setTargetValue(apvts.getRawParameterValue(ParamIDs::Feedback)->load());
-        const auto offsetValue = apvts.getRawParameterValue(ParamIDs::Offset)->load();
-        const auto detuneValue = apvts.getRawParameterValue(ParamIDs::Detune)->load();
+        const auto numChannels = juce::jmin(totalNumInputChannels, buffer.getNumChannels(), maxChannels);
+        const auto polyphonic = parameterEngine.isPolyphonic();
+
+        // linked: one pitch from the mid signal drives every channel, independent: each channel follows itself
+        const auto linked = numChannels == 1 || ! parameterEngine.isIndependent();
+        const auto numTracked = linked ? 1 : numChannels;
+
+        // analysis happens on the worker, here we only hand over the dry input
+        {
+            FEEDBACK_PROFILE_SCOPE(&profiler, analysisPush);
+            pushToAnalysers(buffer, numChannels, linked);
+        }
+
+        if (analyseInline)
+        {
+            for (int ch = 0; ch < numTracked; ch++)
+                channels[(size_t) ch].analyser.processPendingSamples(*inlineScratch);
+        }
+        else
+        {
+            for (int ch = 0; ch < numTracked; ch++)
+                analysisService->get().wake(channels[(size_t) ch].analysisSlot);
+        }
+
+        for (int ch = 0; ch < numTracked; ch++)
+            updateFreq(channels[(size_t) ch], polyphonic);
+
+        // look-ahead: the dry signal waits as long as the analysis does, so the tone lines up with the note it follows.
+        // Zero latency still feeds the delay's history, so switching over crossfades instead of starting from silence
+        {
+            FEEDBACK_PROFILE_SCOPE(&profiler, dryDelay);
+            const auto latency = getLookAheadLatency();
+            dryDelay.process(buffer, numChannels, latency);
+            lookAheadLatency.store(latency, std::memory_order_relaxed);
+        }
 
-        for (int sample = 0; sample < buffer.getNumSamples(); sample++)
+        // ramps -> frequencies and gains for a chunk, render the tone in one go, then one multiply-add into the input
+        FEEDBACK_PROFILE_SCOPE(&profiler, oscillator);
+        const auto& kernels = channelKernels.orGenericFor(numChannels);
+        for (int start = 0; start < buffer.getNumSamples(); start += SineOscillator::maxChunkSize)
         {
-            pushNextSampleIntoFifo(channelData[sample]);
-            
-            const auto tempFrequency = frequencyRamp.getNextValue() * std::pow(semitoneConstant, offsetValue) + detuneValue;
-            const auto increment = tempFrequency * wtSize / curSampleRate;
-            channelData[sample] += waveTable.get(phase) * (feedbackRamp.getNextValue() / 2.0f);
-            phase = fmod((phase + increment), wtSize);
+            const auto numSamples = juce::jmin(SineOscillator::maxChunkSize, buffer.getNumSamples() - start);
+
+            // the feedback gain, offset ratio and detune are shared by every channel
+            parameterEngine.fillFeedbackGains(toneGains.data(), numSamples);
+            juce::FloatVectorOperations::multiply(toneGains.data(), 0.5f, numSamples);
+            parameterEngine.fillOffsetRatios(toneOffsetRatios.data(), numSamples);
+            parameterEngine.fillDetunes(toneDetunes.data(), numSamples);
+
+            for (int ch = 0; ch < numTracked; ch++)
+            {
+                renderTone(channels[(size_t) ch], polyphonic, numSamples);
+
+                if (linked)
+                {
+                    kernels.addToAll(buffer.getArrayOfWritePointers(), numChannels, start, toneBuffer.data(), toneGains.data(), numSamples);
+                }
+                else
+                {
+                    juce::FloatVectorOperations::addWithMultiply(buffer.getWritePointer(ch, start), toneBuffer.data(), toneGains.data(), numSamples);
+                }
+            }
         }
     }
 
-    // Gain ramp for main "gain out"
-    gain = apvts.getRawParameterValue(ParamIDs::Gain)->load();
-    if (gain == previousGain) {
-        buffer.applyGain(gain);
+    // Gain ramp for main "gain out" - a flat gain once it has settled
+    FEEDBACK_PROFILE_SCOPE(&profiler, gainStage);
+    if (! parameterEngine.isOutputGainSmoothing())
+    {
+        buffer.applyGain(parameterEngine.getOutputGain());
+        return;
     }
-    else {
-        buffer.applyGainRamp(0, buffer.getNumSamples(), previousGain, gain);
-        previousGain = gain;
+
+    for (int start = 0; start < buffer.getNumSamples(); start += SineOscillator::maxChunkSize)
+    {
+        const auto numSamples = juce::jmin(SineOscillator::maxChunkSize, buffer.getNumSamples() - start);
+        parameterEngine.fillOutputGains(outputGains.data(), numSamples);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch, start), outputGains.data(), numSamples);
     }
 }
 
-// Helper function for pushSample: finds fundamental and decides if infinite sustain
-void FeedbackAudioProcessor::updateFreq()
+// Helper function for processBlock: writes the next numSamples ramp values, or a flat fill once the ramp has settled
+void FeedbackAudioProcessor::fillFromRamp(juce::LinearSmoothedValue<float>& ramp, float* dest, int numSamples) noexcept
 {
-    const auto tempFrequency = getFundamentalFrequency();
-    if (tempFrequency > lowestGuitarFreq && tempFrequency < highestGuitarFreq)
+    if (! ramp.isSmoothing())
     {
-        frequencyRamp.setTargetValue(tempFrequency);
+        juce::FloatVectorOperations::fill(dest, ramp.getTargetValue(), numSamples);
+        return;
     }
+
+    for (int i = 0; i < numSamples; i++)
+        dest[i] = ramp.getNextValue();
 }
 
-// helper function for process block - pushes sample into the fifo array 
-// calls other helpers to set correct frequency
-void FeedbackAudioProcessor::pushNextSampleIntoFifo(float sample) noexcept
+// Helper function for processBlock: picks up the pitch (or notes) published by the channel's analyser
+void FeedbackAudioProcessor::updateFreq(ChannelState& channel, bool polyphonic)
 {
-    // condition for FFT being ready (full)
-    if (fifoIndex == fftSize)      
+    // checked before reading the frequency, so a fresh estimate is never paired with a stale value
+    const auto snap = channel.snapToNextEstimate && channel.analyser.hasEstimateSince(channel.pendingOnset);
+
+    // the analyser only publishes frequencies inside the guitar range, so anything non-zero sustains
+    const auto tempFrequency = channel.analyser.getLatestFrequency();
+    if (tempFrequency > 0.0f && snap)
+    {
+        channel.frequencyRamp.setCurrentAndTargetValue(tempFrequency);
+        channel.snapToNextEstimate = false;
+    }
+    else if (tempFrequency > 0.0f)
     {
-        std::fill(fftData.begin(), fftData.end(), 0.0f);
-        std::copy(fifo.begin(), fifo.end(), fftData.begin()); 
-        fifoIndex = 0;
-        window.multiplyWithWindowingTable(fftData.data(), fftSize);
-        forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
-        updateFreq();
+        channel.frequencyRamp.setTargetValue(tempFrequency);
     }
-    fifo[fifoIndex++] = sample;
+
+    if (polyphonic && channel.analyser.getLatestNotes(channel.noteSet, channel.noteSequence))
+        channel.oscillatorBank.setNotes(channel.noteSet.frequencies.data(), channel.noteSet.numNotes);
 }
 
-float FeedbackAudioProcessor::getFundamentalFrequency()
+// Helper function for processBlock: copies the dry input into the analysers' ring buffers,
+// summed to mid in chunks when the channels are linked
+void FeedbackAudioProcessor::pushToAnalysers(const juce::AudioBuffer<float>& buffer, int numChannels, bool linked)
 {
-    // tolerance determines how easy it is to generate feedback
-    auto toleranceValue = apvts.getRawParameterValue(ParamIDs::Tolerance)->load();
-    float max = 0.0f;
-    int index = 0;
-    float absVal;
-
-    for (auto i = 0; i < fftSize; i++)
+    if (! linked || numChannels == 1)
     {
-        absVal = abs(fftData[i]);
-        if (absVal > max)
+        for (int ch = 0; ch < numChannels; ch++)
         {
-            max = absVal;
-            index = i;
+            detectOnset(channels[(size_t) ch], buffer.getReadPointer(ch), buffer.getNumSamples());
+            channels[(size_t) ch].analyser.pushSamples(buffer.getReadPointer(ch), buffer.getNumSamples());
         }
+        return;
+    }
+
+    const auto& kernels = channelKernels.orGenericFor(numChannels);
+    for (int start = 0; start < buffer.getNumSamples(); start += SineOscillator::maxChunkSize)
+    {
+        const auto numSamples = juce::jmin(SineOscillator::maxChunkSize, buffer.getNumSamples() - start);
+
+        kernels.sumToMid(midBuffer.data(), buffer.getArrayOfReadPointers(), numChannels, start, numSamples);
+
+        detectOnset(channels[0], midBuffer.data(), numSamples);
+        channels[0].analyser.pushSamples(midBuffer.data(), numSamples);
     }
-    if (max > (toleranceValue * toleranceConstant))
+}
+
+// Helper function for pushToAnalysers: runs before the samples are pushed, so the worker
+// restarts its windows with the attack itself rather than just after it
+void FeedbackAudioProcessor::detectOnset(ChannelState& channel, const float* samples, int numSamples) noexcept
+{
+    if (channel.onsetDetector.process(samples, numSamples))
+    {
+        channel.pendingOnset = channel.analyser.notifyOnset();
+        channel.snapToNextEstimate = true;
+    }
+}
+
+// Helper function for processBlock: renders the next numSamples of one channel's tone into toneBuffer,
+// following the chunk's offset ratios and detunes
+void FeedbackAudioProcessor::renderTone(ChannelState& channel, bool polyphonic, int numSamples)
+{
+    // the bank follows the ramps a sub-block at a time, the same as its own glides
+    if (polyphonic)
+    {
+        channel.oscillatorBank.render(toneOffsetRatios.data(), toneDetunes.data(), toneBuffer.data(), numSamples);
+        return;
+    }
+
+    fillFromRamp(channel.frequencyRamp, toneFrequencies.data(), numSamples);
+    juce::FloatVectorOperations::multiply(toneFrequencies.data(), toneOffsetRatios.data(), numSamples);
+    juce::FloatVectorOperations::add(toneFrequencies.data(), toneDetunes.data(), numSamples);
+    channel.oscillator.render(toneFrequencies.data(), toneBuffer.data(), numSamples);
+}
+
+void FeedbackAudioProcessor::removeFromAnalysisService()
+{
+    for (int ch = 0; ch < numServicedChannels; ch++)
     {
-        return static_cast<float> (index) / (fftSize - 1) * curSampleRate;
+        analysisService->get().remove(channels[(size_t) ch].analyser);
+        channels[(size_t) ch].analysisSlot = -1;
     }
-    return 0;
+
+    numServicedChannels = 0;
 }
 
 //==============================================================================
@@ -235,25 +436,24 @@ juce::AudioProcessorEditor* FeedbackAudioProcessor::createEditor()
 //==============================================================================
 void FeedbackAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xmlAPVTS (state.createXml());
-    copyXmlToBinary(*xmlAPVTS, destData);
+    // compact binary record of every parameter's value - see PresetBank
+    presetBank.writeState(destData);
 }
 
 void FeedbackAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    
+    if (presetBank.readState(data, sizeInBytes))
+        return;
+
+    // sessions saved before the binary format hold the value tree as XML
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary(data, sizeInBytes));
     
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName(apvts.state.getType()))
+        {
             apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+            presetBank.setCurrentPresetIndex(0);
+        }
 }
 
 //==============================================================================
@@ -291,6 +491,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout FeedbackAudioProcessor::crea
     layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID { ParamIDs::Detune, 1 },
                                                            ParamIDs::Detune,
                                                            -50.0f, 50.0f, 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParamIDs::HopSize, 1 },
+                                                            ParamIDs::HopSize,
+                                                            juce::StringArray { "1/1 window", "1/2 window", "1/4 window", "1/8 window" }, // 0% / 50% / 75% / 87.5% overlap
+                                                            2));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParamIDs::Detector, 1 },
+                                                            ParamIDs::Detector,
+                                                            juce::StringArray { "FFT", "YIN", "Resonators" },
+                                                            0));
+    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID { ParamIDs::Voices, 1 },
+                                                         ParamIDs::Voices,
+                                                         1, PitchAnalyser::maxNotes, 1));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID { ParamIDs::ChannelMode, 1 },
+                                                            ParamIDs::ChannelMode,
+                                                            juce::StringArray { "Linked", "Independent" },
+                                                            0));
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID { ParamIDs::Hold, 1 },
+                                                          ParamIDs::Hold,
+                                                          false)); // sustained notes skip analysis frames once they're stable
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID { ParamIDs::LookAhead, 1 },
+                                                          ParamIDs::LookAhead,
+                                                          false)); // delays the dry signal by the analysis latency and reports it to the host
 
     return layout;
 }
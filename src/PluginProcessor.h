@@ -9,6 +9,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PitchAnalyser.h"
+#include "AnalysisService.h"
+#include "SineOscillator.h"
+#include "OscillatorBank.h"
+#include "OnsetDetector.h"
+#include "Profiler.h"
+#include "ChannelKernels.h"
+#include "ParameterEngine.h"
+#include "PresetBank.h"
+#include "DryDelay.h"
 
 //==============================================================================
 /**
@@ -21,9 +31,16 @@ namespace ParamIDs
     inline constexpr auto Offset { "Offset" };
     inline constexpr auto Tolerance { "Tolerance" };
     inline constexpr auto Detune { "Detune" };
+    inline constexpr auto HopSize { "HopSize" };
+    inline constexpr auto Detector { "Detector" };
+    inline constexpr auto Voices { "Voices" };
+    inline constexpr auto ChannelMode { "ChannelMode" };
+    inline constexpr auto Hold { "Hold" };
+    inline constexpr auto LookAhead { "LookAhead" };
 };
 
-class FeedbackAudioProcessor  : public juce::AudioProcessor
+class FeedbackAudioProcessor  : public juce::AudioProcessor,
+                                private juce::Timer
 {
 public:
     //==============================================================================
@@ -64,45 +81,107 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
 
-    void pushNextSampleIntoFifo(float sample) noexcept;
-    float getFundamentalFrequency();
-    void updateFreq();
+    // delay from a played note to the analyser picking it up (window centre + one hop)
+    int getAnalysisLatencySamples() const noexcept { return channels[0].analyser.getLatencySamples(); }
+
+    // a channel's latest single-pitch estimate in Hz (0 if none yet) and newest note set, for tests and tools
+    float getDetectedFrequency (int channel) const noexcept { return channels[(size_t) channel].analyser.getLatestFrequency(); }
+    bool getDetectedNotes (int channel, PitchAnalyser::NoteSet& dest) const noexcept;
+
+    // analysis frames run and skipped by hold mode, summed over the channels since the last prepareToPlay
+    PitchAnalyser::HoldStats getHoldStats() const noexcept;
+
+    // analysis input dropped because a worker fell behind, summed over the channels since the last prepareToPlay
+    juce::int64 getNumDroppedAnalysisSamples() const noexcept;
+
+    // the first channel's (or the mid signal's) spectrum and pitch, for the editor's display
+    SpectrumFeed& getSpectrumFeed() noexcept { return spectrumFeed; }
+
+   #if FEEDBACK_ENABLE_PROFILING
+    // per-stage timings
+    Profiler& getProfiler() noexcept { return profiler; }
+   #endif
 
     // value tree for parameters 
     juce::AudioProcessorValueTreeState apvts;
 
     // constants 
-    static constexpr auto fftOrder = 12;          /* 12 creates enough detail without huge lag - 10 is safest */
-    static constexpr auto fftSize = 1 << fftOrder;
-    static constexpr auto lowestGuitarFreq = 75;
-    static constexpr auto highestGuitarFreq = 1200;
-    static constexpr auto semitoneConstant = 1.05945;
-    static constexpr auto toleranceConstant = 250;
+    static constexpr auto maxChannels = 4;
 
 private:
     //==============================================================================
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
 
-    // ramp for feedback gain 
-    juce::LinearSmoothedValue<float> feedbackRamp { 0.0f };
-    juce::LinearSmoothedValue<float> frequencyRamp { 0.0f };
+    // everything that follows one channel's pitch - analysis in, feedback tone out
+    struct ChannelState
+    {
+        PitchAnalyser analyser;
+        juce::LinearSmoothedValue<float> frequencyRamp { 0.0f };
+        SineOscillator oscillator;
+
+        // a picked note jumps straight to the first estimate made after it instead of gliding there
+        OnsetDetector onsetDetector;
+        juce::uint32 pendingOnset = 0;
+        bool snapToNextEstimate = false;
+
+        // multi-voice mode: one oscillator lane per detected note
+        OscillatorBank oscillatorBank;
+        PitchAnalyser::NoteSet noteSet;
+        juce::uint32 noteSequence = 0;
+
+        // where the shared service has this channel's analyser, -1 when it isn't registered
+        int analysisSlot = -1;
+    };
+
+    static void fillFromRamp(juce::LinearSmoothedValue<float>& ramp, float* dest, int numSamples) noexcept;
+    void updateFreq(ChannelState& channel, bool polyphonic);
+    void pushToAnalysers(const juce::AudioBuffer<float>& buffer, int numChannels, bool linked);
+    static void detectOnset(ChannelState& channel, const float* samples, int numSamples) noexcept;
+    void renderTone(ChannelState& channel, bool polyphonic, int numSamples);
+    void removeFromAnalysisService();
+    int getLookAheadLatency() const noexcept;
+    void timerCallback() override;
+
+    // resolved parameter atomics and their smoothed values - processBlock never goes back to the value tree
+    ParameterEngine parameterEngine { apvts };
+
+    // factory presets for the host's program list, and the binary session state
+    PresetBank presetBank { apvts };
+
+    // per-channel state lives side by side; in linked mode only channels[0] is used
+    std::array<ChannelState, maxChannels> channels;
+
+    // FFT + pitch detection runs on the threads shared by every instance, fed from processBlock
+    // (or inline when rendering offline, with scratch of our own). The service is only joined the
+    // first time we're prepared for realtime, so an offline-only processor never starts its threads
+    std::optional<juce::SharedResourcePointer<AnalysisService>> analysisService;
+    int numServicedChannels = 0;
+    bool analyseInline = false;
+    std::unique_ptr<PitchAnalyser::Scratch> inlineScratch;
+
+   #if FEEDBACK_ENABLE_PROFILING
+    Profiler profiler;
+   #endif
+    SpectrumFeed spectrumFeed;
+
+    // look-ahead mode: the dry path waits for the analysis. The audio thread publishes the delay it used,
+    // the message thread passes changes on to the host
+    DryDelay dryDelay;
+    std::atomic<int> lookAheadLatency { 0 };
 
-    // PRIVATE MEMBER VARIABLES FOR FFT
-    juce::dsp::FFT forwardFFT;
-    juce::dsp::WindowingFunction<float> window;
-    std::array<float, fftSize> fifo;
-    std::array<float, fftSize * 2> fftData;
-    int fifoIndex = 0;
+    // inner loops specialised for the prepared channel count
+    ChannelKernels channelKernels;
 
     double curSampleRate;
 
-    float gain;
-    float previousGain;
-
-    // linear interpolation between values should get a slightly cleaner sine signal
-    juce::dsp::LookupTable<float> waveTable;
-    double wtSize;
-    double phase;
+    // feedback tone is rendered a chunk at a time into scratch, then mixed in with one multiply-add
+    std::array<float, SineOscillator::maxChunkSize> toneFrequencies;
+    std::array<float, SineOscillator::maxChunkSize> toneGains;
+    std::array<float, SineOscillator::maxChunkSize> toneBuffer;
+    std::array<float, SineOscillator::maxChunkSize> midBuffer;
+    std::array<float, SineOscillator::maxChunkSize> toneOffsetRatios;
+    std::array<float, SineOscillator::maxChunkSize> toneDetunes;
+    std::array<float, SineOscillator::maxChunkSize> outputGains;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FeedbackAudioProcessor)
 };
@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    Parameter sets without the value tree. State is saved as a short binary
+    record (a header, then one id hash and plain value per parameter), and
+    the factory presets are kept as flat arrays of plain values, so recalling
+    either is a handful of setValueNotifyingHost() calls with no XML and no
+    allocation. Sessions saved as XML by older versions still load.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PresetBank.h"
+
+PresetBank::PresetBank (juce::AudioProcessorValueTreeState& apvts)
+{
+    for (auto* parameter : apvts.processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+        {
+            parameters.push_back (ranged);
+            idHashes.push_back (hashID (ranged->getParameterID()));
+            defaults.push_back (ranged->convertFrom0to1 (ranged->getDefaultValue()));
+        }
+    }
+
+    restored.resize (parameters.size());
+
+    // anything a preset doesn't mention stays at its default
+    addPreset ("Default", {});
+    addPreset ("Octave Bloom", { { ParamIDs::Feedback, 0.6f }, { ParamIDs::Offset, 12.0f }, { ParamIDs::Tolerance, 0.4f } });
+    addPreset ("Fifth Above", { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Offset, 7.0f } });
+    addPreset ("Two Octaves", { { ParamIDs::Feedback, 0.4f }, { ParamIDs::Offset, 24.0f } });
+    addPreset ("Unison Swell", { { ParamIDs::Feedback, 0.7f }, { ParamIDs::Offset, 0.0f }, { ParamIDs::Hold, 1.0f } });
+    addPreset ("Chorused Octave", { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Offset, 12.0f }, { ParamIDs::Detune, 12.0f } });
+    addPreset ("Fast Attack", { { ParamIDs::Feedback, 0.6f }, { ParamIDs::Offset, 12.0f }, { ParamIDs::Detector, 2.0f } });
+    addPreset ("Chords", { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Offset, 12.0f }, { ParamIDs::Voices, 6.0f } });
+    addPreset ("Split Stereo", { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Offset, 12.0f }, { ParamIDs::ChannelMode, 1.0f } });
+}
+
+void PresetBank::addPreset (const juce::String& name, std::initializer_list<std::pair<const char*, float>> changes)
+{
+    Preset preset { name, defaults };
+
+    for (const auto& change : changes)
+    {
+        const auto index = indexOfHash (hashID (change.first));
+        jassert (index >= 0);   // a preset names a parameter that doesn't exist
+
+        if (index >= 0)
+            preset.values[(size_t) index] = change.second;
+    }
+
+    presets.push_back (std::move (preset));
+}
+
+const juce::String& PresetBank::getPresetName (int index) const noexcept
+{
+    return presets[(size_t) juce::jlimit (0, getNumPresets() - 1, index)].name;
+}
+
+void PresetBank::renamePreset (int index, const juce::String& newName)
+{
+    if (juce::isPositiveAndBelow (index, getNumPresets()))
+        presets[(size_t) index].name = newName;
+}
+
+void PresetBank::applyPreset (int index)
+{
+    if (! juce::isPositiveAndBelow (index, getNumPresets()))
+        return;
+
+    currentPreset = index;
+    const auto& values = presets[(size_t) index].values;
+
+    for (size_t i = 0; i < parameters.size(); i++)
+        setPlainValue (*parameters[i], values[i]);
+}
+
+void PresetBank::setCurrentPresetIndex (int index) noexcept
+{
+    currentPreset = juce::jlimit (0, getNumPresets() - 1, index);
+}
+
+//==============================================================================
+void PresetBank::writeState (juce::MemoryBlock& destData) const
+{
+    destData.setSize (0);
+    destData.ensureSize ((size_t) (headerSize + entrySize * (int) parameters.size()));
+
+    // MemoryOutputStream writes little-endian whatever the platform
+    juce::MemoryOutputStream stream (destData, false);
+    stream.writeInt ((int) stateMagic);
+    stream.writeShort ((short) stateVersion);
+    stream.writeShort ((short) parameters.size());
+    stream.writeInt (currentPreset);
+
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        stream.writeInt ((int) idHashes[i]);
+        stream.writeFloat (parameters[i]->convertFrom0to1 (parameters[i]->getValue()));
+    }
+}
+
+bool PresetBank::readState (const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
+
+    juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+
+    if ((juce::uint32) stream.readInt() != stateMagic)
+        return false;
+
+    // a newer version may append fields after the entries, but never changes what comes before them
+    const auto version = (int) stream.readShort();
+    const auto numEntries = (int) (juce::uint16) stream.readShort();
+    const auto preset = stream.readInt();
+
+    if (version < 1 || sizeInBytes < headerSize + entrySize * numEntries)
+        return false;
+
+    std::fill (restored.begin(), restored.end(), 0);
+
+    for (int i = 0; i < numEntries; i++)
+    {
+        const auto hash = (juce::uint32) stream.readInt();
+        const auto value = stream.readFloat();
+        const auto index = indexOfHash (hash);
+
+        if (index >= 0 && std::isfinite (value))
+        {
+            setPlainValue (*parameters[(size_t) index], value);
+            restored[(size_t) index] = 1;
+        }
+    }
+
+    for (size_t i = 0; i < parameters.size(); i++)
+        if (! restored[i])
+            setPlainValue (*parameters[i], defaults[i]);
+
+    setCurrentPresetIndex (preset);
+    return true;
+}
+
+//==============================================================================
+void PresetBank::setPlainValue (juce::RangedAudioParameter& parameter, float value)
+{
+    const auto normalised = parameter.convertTo0to1 (value);
+
+    // recalling a scene mostly rewrites values that haven't changed - don't bother the host with those
+    if (parameter.getValue() != normalised)
+        parameter.setValueNotifyingHost (normalised);
+}
+
+int PresetBank::indexOfHash (juce::uint32 hash) const noexcept
+{
+    for (size_t i = 0; i < idHashes.size(); i++)
+        if (idHashes[i] == hash)
+            return (int) i;
+
+    return -1;
+}
+
+juce::uint32 PresetBank::hashID (const juce::String& parameterID) noexcept
+{
+    // 32 bit FNV-1a over the UTF-8 bytes
+    juce::uint32 hash = 2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; c++)
+    {
+        hash ^= (juce::uint8) *c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
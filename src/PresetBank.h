@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    Parameter sets without the value tree. State is saved as a short binary
+    record (a header, then one id hash and plain value per parameter), and
+    the factory presets are kept as flat arrays of plain values, so recalling
+    either is a handful of setValueNotifyingHost() calls with no XML and no
+    allocation. Sessions saved as XML by older versions still load.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class PresetBank
+{
+public:
+    //==============================================================================
+    // resolves every parameter of the value tree and builds the factory presets from its defaults
+    explicit PresetBank (juce::AudioProcessorValueTreeState& apvts);
+
+    int getNumPresets() const noexcept          { return (int) presets.size(); }
+    int getCurrentPreset() const noexcept       { return currentPreset; }
+    const juce::String& getPresetName (int index) const noexcept;
+
+    // message thread
+    void renamePreset (int index, const juce::String& newName);
+
+    // message thread - moves every parameter to the preset's values. Nothing is allocated, and the
+    // processor's ramps glide the gains, offset and detune to their new settings
+    void applyPreset (int index);
+
+    // message thread - the current value of every parameter, plus the current preset index
+    void writeState (juce::MemoryBlock& destData) const;
+
+    // message thread - false (and nothing changed) if data isn't a binary state, so the caller can try XML.
+    // Parameters the data doesn't mention go back to their defaults, unknown ones are skipped
+    bool readState (const void* data, int sizeInBytes);
+
+    // after an XML state was restored, which only carries parameters
+    void setCurrentPresetIndex (int index) noexcept;
+
+    // constants
+    static constexpr juce::uint32 stateMagic = 0x74734246;  /* "FBst" read as little-endian */
+    static constexpr int stateVersion = 1;
+    static constexpr int headerSize = 12;       /* magic, version (16 bit), count (16 bit), preset (32 bit) */
+    static constexpr int entrySize = 8;         /* id hash, plain value */
+
+private:
+    //==============================================================================
+    struct Preset
+    {
+        juce::String name;
+        std::vector<float> values;      // plain values, in the order of parameters
+    };
+
+    void addPreset (const juce::String& name, std::initializer_list<std::pair<const char*, float>> changes);
+    void setPlainValue (juce::RangedAudioParameter& parameter, float value);
+    int indexOfHash (juce::uint32 hash) const noexcept;
+    static juce::uint32 hashID (const juce::String& parameterID) noexcept;
+
+    std::vector<juce::RangedAudioParameter*> parameters;
+    std::vector<juce::uint32> idHashes;     // stable across builds and platforms, unlike String::hashCode()
+    std::vector<float> defaults;
+    std::vector<char> restored;             // readState()'s bookkeeping, sized once so loading doesn't allocate
+    std::vector<Preset> presets;
+    int currentPreset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
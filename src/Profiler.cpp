@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    Optional timing of the hot path. Build with FEEDBACK_ENABLE_PROFILING=1 to
+    turn it on; otherwise the scope macros expand to nothing and nothing
+    holds a Profiler. Every writing thread has its own histograms, merged
+    when they're read, so timing a stage never shares a cache line.
+
+  ==============================================================================
+*/
+
+#include "Profiler.h"
+
+//==============================================================================
+const char* Profiler::getStageName (Stage stage) noexcept
+{
+    switch (stage)
+    {
+        case Stage::processBlock:   return "processBlock";
+        case Stage::analysisPush:   return "analysis push";
+        case Stage::dryDelay:       return "dry delay";
+        case Stage::oscillator:     return "oscillator";
+        case Stage::gainStage:      return "gain stage";
+        case Stage::analysisFrame:  return "analysis frame";
+        case Stage::peakSearch:     return "peak search";
+        case Stage::holdCheck:      return "hold check";
+        case Stage::numStages:
+        default:                    break;
+    }
+
+    return "";
+}
+
+Profiler::Stats Profiler::getStats (Stage stage) const noexcept
+{
+    Stats stats;
+    auto total = 0.0;
+    auto minimum = std::numeric_limits<juce::uint64>::max();
+    juce::uint64 maximum = 0;
+    std::array<juce::uint64, numBuckets> buckets {};
+
+    for (const auto& writer : writers)
+    {
+        const auto& histogram = writer.stages[(size_t) stage];
+
+        stats.count += histogram.count.load (std::memory_order_relaxed);
+        total += static_cast<double> (histogram.total.load (std::memory_order_relaxed));
+        minimum = juce::jmin (minimum, histogram.minimum.load (std::memory_order_relaxed));
+        maximum = juce::jmax (maximum, histogram.maximum.load (std::memory_order_relaxed));
+
+        for (auto bucket = 0; bucket < numBuckets; bucket++)
+            buckets[(size_t) bucket] += histogram.buckets[(size_t) bucket].load (std::memory_order_relaxed);
+    }
+
+    if (stats.count == 0)
+        return stats;
+
+    stats.minNanoseconds = static_cast<double> (minimum);
+    stats.maxNanoseconds = static_cast<double> (maximum);
+    stats.meanNanoseconds = total / static_cast<double> (stats.count);
+
+    // walk up the buckets until 99% of the measurements are below
+    const auto target = static_cast<juce::uint64> (std::ceil (0.99 * static_cast<double> (stats.count)));
+    juce::uint64 seen = 0;
+    for (auto bucket = 0; bucket < numBuckets; bucket++)
+    {
+        seen += buckets[(size_t) bucket];
+        if (seen >= target)
+        {
+            stats.p99Nanoseconds = juce::jmin (getBucketUpperEdge (bucket), stats.maxNanoseconds);
+            break;
+        }
+    }
+
+    return stats;
+}
+
+void Profiler::reset() noexcept
+{
+    for (auto& writer : writers)
+    {
+        for (auto& histogram : writer.stages)
+        {
+            histogram.count.store (0, std::memory_order_relaxed);
+            histogram.total.store (0, std::memory_order_relaxed);
+            histogram.minimum.store (std::numeric_limits<juce::uint64>::max(), std::memory_order_relaxed);
+            histogram.maximum.store (0, std::memory_order_relaxed);
+
+            for (auto& bucket : histogram.buckets)
+                bucket.store (0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Profiler::record (Stage stage, juce::uint64 nanoseconds, int writer) noexcept
+{
+    jassert (juce::isPositiveAndBelow (writer, numWriters));
+    auto& histogram = writers[(size_t) writer].stages[(size_t) stage];
+
+    // single writer, so plain loads and stores - no locked instructions on the hot path
+    const auto add = [] (auto& value, auto amount) { value.store (value.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed); };
+    add (histogram.count, (juce::uint64) 1);
+    add (histogram.total, nanoseconds);
+    add (histogram.buckets[(size_t) getBucket (nanoseconds)], (juce::uint32) 1);
+
+    if (nanoseconds < histogram.minimum.load (std::memory_order_relaxed))
+        histogram.minimum.store (nanoseconds, std::memory_order_relaxed);
+
+    if (nanoseconds > histogram.maximum.load (std::memory_order_relaxed))
+        histogram.maximum.store (nanoseconds, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// octave from the highest set bit, then the next two bits pick the quarter within it
+int Profiler::getBucket (juce::uint64 nanoseconds) noexcept
+{
+    const auto value = static_cast<juce::uint32> (juce::jlimit<juce::uint64> (1, std::numeric_limits<juce::uint32>::max(), nanoseconds));
+    const auto octave = juce::findHighestSetBit (value);
+    const auto quarter = octave >= 2 ? static_cast<int> ((value >> (octave - 2)) & 3) : 0;
+
+    return juce::jmin (numBuckets - 1, octave * bucketsPerOctave + quarter);
+}
+
+double Profiler::getBucketUpperEdge (int bucket) noexcept
+{
+    const auto octave = bucket / bucketsPerOctave;
+    const auto quarter = bucket % bucketsPerOctave;
+
+    return std::ldexp (1.0 + (quarter + 1) / static_cast<double> (bucketsPerOctave), octave);
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    Optional timing of the hot path. Build with FEEDBACK_ENABLE_PROFILING=1 to
+    turn it on; otherwise the scope macros expand to nothing and nothing
+    holds a Profiler. Every writing thread has its own histograms, merged
+    when they're read, so timing a stage never shares a cache line.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef FEEDBACK_ENABLE_PROFILING
+ #define FEEDBACK_ENABLE_PROFILING 0
+#endif
+
+//==============================================================================
+/**
+*/
+class Profiler
+{
+public:
+    //==============================================================================
+    // audio thread stages first, then the ones that run wherever the analysis runs
+    enum class Stage
+    {
+        processBlock = 0,   // the whole callback
+        analysisPush,       // copying (or mid-summing) the input into the analysers' rings
+        dryDelay,           // look-ahead delay of the dry signal (just the history copy at zero latency)
+        oscillator,         // rendering and mixing the feedback tone
+        gainStage,          // output gain ramp
+        analysisFrame,      // one analysis frame - window + FFT, or YIN
+        peakSearch,         // peak / note search inside a frame
+        holdCheck,          // the held-pitch check that stands in for a frame while a note is held
+        numStages
+    };
+
+    static constexpr auto numStages = static_cast<int> (Stage::numStages);
+
+    // writers: the audio thread (which also runs inline analysis), then one per AnalysisService worker
+    static constexpr auto audioThreadWriter = 0;
+    static constexpr auto numWriters = 9;
+    static constexpr bool isEnabled() noexcept { return FEEDBACK_ENABLE_PROFILING != 0; }
+    static const char* getStageName (Stage stage) noexcept;
+
+    struct Stats
+    {
+        juce::uint64 count = 0;
+        double minNanoseconds = 0.0;
+        double meanNanoseconds = 0.0;
+        double maxNanoseconds = 0.0;
+        double p99Nanoseconds = 0.0;    // upper edge of the histogram bucket holding the 99th percentile
+    };
+
+    //==============================================================================
+    // any thread - every writer's histogram merged, possibly torn between fields while a stage is being written
+    Stats getStats (Stage stage) const noexcept;
+
+    // any thread - a measurement being recorded at the same moment may survive it
+    void reset() noexcept;
+
+    // adds one measurement - wait-free, but only ever one thread per writer index
+    void record (Stage stage, juce::uint64 nanoseconds, int writer) noexcept;
+
+    //==============================================================================
+    // times the enclosing scope into a stage; a null profiler records nothing
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer (Profiler* profilerToUse, Stage stageToTime, int writerIndex) noexcept
+            : profiler (profilerToUse), stage (stageToTime), writer (writerIndex), start (std::chrono::steady_clock::now()) {}
+
+        ~ScopedTimer()
+        {
+            if (profiler != nullptr)
+                profiler->record (stage, static_cast<juce::uint64> (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now() - start).count()),
+                                  writer);
+        }
+
+    private:
+        Profiler* profiler;
+        Stage stage;
+        int writer;
+        std::chrono::steady_clock::time_point start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedTimer)
+    };
+
+private:
+    //==============================================================================
+    // log-spaced buckets, four per octave of nanoseconds, topping out around 4 s
+    static constexpr auto bucketsPerOctave = 4;
+    static constexpr auto numBuckets = 32 * bucketsPerOctave;
+    static int getBucket (juce::uint64 nanoseconds) noexcept;
+    static double getBucketUpperEdge (int bucket) noexcept;
+
+    // atomic only so getStats() can read while the writer carries on - the writer itself never needs a read-modify-write
+    struct Histogram
+    {
+        std::atomic<juce::uint64> count { 0 };
+        std::atomic<juce::uint64> total { 0 };
+        std::atomic<juce::uint64> minimum { std::numeric_limits<juce::uint64>::max() };
+        std::atomic<juce::uint64> maximum { 0 };
+        std::array<std::atomic<juce::uint32>, numBuckets> buckets {};
+    };
+
+    // one writer's stages, on cache lines no other writer touches
+    struct alignas (64) WriterHistograms
+    {
+        std::array<Histogram, numStages> stages;
+    };
+
+    std::array<WriterHistograms, numWriters> writers;
+};
+
+#if FEEDBACK_ENABLE_PROFILING
+ // on the audio thread
+ #define FEEDBACK_PROFILE_SCOPE(profiler, stage) \
+    FEEDBACK_PROFILE_WRITER_SCOPE (profiler, stage, Profiler::audioThreadWriter)
+
+ // wherever the analysis runs - the writer comes from the Scratch of the thread doing the pass
+ #define FEEDBACK_PROFILE_WRITER_SCOPE(profiler, stage, writer) \
+    const Profiler::ScopedTimer JUCE_JOIN_MACRO (profileScope_, __LINE__) (profiler, Profiler::Stage::stage, writer)
+#else
+ #define FEEDBACK_PROFILE_SCOPE(profiler, stage)
+ #define FEEDBACK_PROFILE_WRITER_SCOPE(profiler, stage, writer)
+#endif
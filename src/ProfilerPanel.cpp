@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Debug panel for the editor: a table of the Profiler's per-stage timings,
+    refreshed a few times a second. Only built into profiling builds.
+
+  ==============================================================================
+*/
+
+#include "ProfilerPanel.h"
+
+//==============================================================================
+ProfilerPanel::ProfilerPanel (Profiler& p)
+    : profiler (p)
+{
+    addAndMakeVisible (resetButton);
+    resetButton.onClick = [this] { profiler.reset(); };
+
+    startTimerHz (4);
+}
+
+ProfilerPanel::~ProfilerPanel()
+{
+    stopTimer();
+}
+
+//==============================================================================
+void ProfilerPanel::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+    g.setColour (juce::Colours::lightgrey);
+    g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 13.0f, juce::Font::plain));
+
+    // all times in microseconds
+    const auto formatRow = [] (const juce::String& name, const juce::String& count, const juce::String& min,
+                               const juce::String& mean, const juce::String& p99, const juce::String& max)
+    {
+        return name.paddedRight (' ', 16) + count.paddedLeft (' ', 10) + min.paddedLeft (' ', 10)
+             + mean.paddedLeft (' ', 10) + p99.paddedLeft (' ', 10) + max.paddedLeft (' ', 10);
+    };
+    const auto toMicroseconds = [] (double nanoseconds) { return juce::String (nanoseconds * 1.0e-3, 2); };
+
+    auto area = getLocalBounds().reduced (4);
+    g.drawText (formatRow ("stage (us)", "count", "min", "mean", "p99", "max"), area.removeFromTop (rowHeight), juce::Justification::centredLeft);
+
+    for (auto stage = 0; stage < Profiler::numStages; stage++)
+    {
+        const auto& stageStats = stats[(size_t) stage];
+        g.drawText (formatRow (Profiler::getStageName (static_cast<Profiler::Stage> (stage)),
+                               juce::String ((juce::int64) stageStats.count),
+                               toMicroseconds (stageStats.minNanoseconds),
+                               toMicroseconds (stageStats.meanNanoseconds),
+                               toMicroseconds (stageStats.p99Nanoseconds),
+                               toMicroseconds (stageStats.maxNanoseconds)),
+                    area.removeFromTop (rowHeight), juce::Justification::centredLeft);
+    }
+}
+
+void ProfilerPanel::resized()
+{
+    resetButton.setBounds (getLocalBounds().reduced (4).removeFromRight (60).removeFromTop (rowHeight + 4));
+}
+
+void ProfilerPanel::timerCallback()
+{
+    for (auto stage = 0; stage < Profiler::numStages; stage++)
+        stats[(size_t) stage] = profiler.getStats (static_cast<Profiler::Stage> (stage));
+
+    repaint();
+}
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    Debug panel for the editor: a table of the Profiler's per-stage timings,
+    refreshed a few times a second. Only built into profiling builds.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Profiler.h"
+
+//==============================================================================
+/**
+*/
+class ProfilerPanel  : public juce::Component,
+                       private juce::Timer
+{
+public:
+    explicit ProfilerPanel (Profiler&);
+    ~ProfilerPanel() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr auto rowHeight = 16;
+    static constexpr auto preferredHeight = rowHeight * (Profiler::numStages + 1) + 8;
+
+private:
+    void timerCallback() override;
+
+    Profiler& profiler;
+    std::array<Profiler::Stats, Profiler::numStages> stats;
+    juce::TextButton resetButton { "Reset" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerPanel)
+};
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    Incremental pitch tracker: a bank of damped complex resonators, one per
+    quarter tone across the guitar range. Every input sample updates all of
+    them, so a fresh estimate is available after any block instead of once
+    per filled window. State is structure-of-arrays for SIMD, like
+    OscillatorBank.
+
+  ==============================================================================
+*/
+
+#include "ResonatorBank.h"
+
+//==============================================================================
+void ResonatorBank::prepare (double sampleRate, float lowestFreq, float highestFreq)
+{
+    // one extra step past each end, so notes right at the edges still have two neighbours to interpolate between
+    lowestFrequency = lowestFreq * std::exp2 (-1.0f / stepsPerOctave);
+    numResonators = juce::jlimit (0, maxResonators, static_cast<int> (std::floor (stepsPerOctave * std::log2 (highestFreq / lowestFreq))) + 3);
+    numActiveLanes = (numResonators + numLanes - 1) / numLanes * numLanes;
+
+    poleRe.fill (0.0f);
+    poleIm.fill (0.0f);
+    inputGains.fill (0.0f);
+
+    // constant Q: each -3 dB band is one grid step wide, so neighbours overlap like adjacent FFT bins
+    const auto bandwidthRatio = std::exp2 (1.0 / stepsPerOctave) - 1.0;
+
+    for (auto k = 0; k < numResonators; k++)
+    {
+        const auto frequency = lowestFrequency * std::exp2 (static_cast<double> (k) / stepsPerOctave);
+        const auto radius = std::exp (-juce::MathConstants<double>::pi * frequency * bandwidthRatio / sampleRate);
+        const auto angle = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+        poleRe[(size_t) k] = static_cast<float> (radius * std::cos (angle));
+        poleIm[(size_t) k] = static_cast<float> (radius * std::sin (angle));
+
+        // unity gain at the centre, so a sine of amplitude A settles at A / 2
+        inputGains[(size_t) k] = static_cast<float> (1.0 - radius);
+
+        if (k == 0)
+            settleSamples = static_cast<int> (std::ceil (1.0 / (1.0 - radius)));
+    }
+
+    reset();
+}
+
+void ResonatorBank::reset() noexcept
+{
+    stateRe.fill (0.0f);
+    stateIm.fill (0.0f);
+}
+
+void ResonatorBank::process (const float* samples, int numSamples) noexcept
+{
+    // the states decay towards zero in silence - keep them out of denormal range
+    juce::ScopedNoDenormals noDenormals;
+
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    // one group of lanes at a time, so the state stays in registers for the whole block
+    for (auto offset = 0; offset < numActiveLanes; offset += (int) Vec::SIMDNumElements)
+    {
+        auto re = Vec::fromRawArray (stateRe.data() + offset);
+        auto im = Vec::fromRawArray (stateIm.data() + offset);
+        const auto pRe = Vec::fromRawArray (poleRe.data() + offset);
+        const auto pIm = Vec::fromRawArray (poleIm.data() + offset);
+        const auto gain = Vec::fromRawArray (inputGains.data() + offset);
+
+        for (auto i = 0; i < numSamples; i++)
+        {
+            const auto nextRe = re * pRe - im * pIm + gain * samples[i];
+            im = re * pIm + im * pRe;
+            re = nextRe;
+        }
+
+        re.copyToRawArray (stateRe.data() + offset);
+        im.copyToRawArray (stateIm.data() + offset);
+    }
+}
+
+PeakDetector::Peak ResonatorBank::findPeak() const noexcept
+{
+    if (numResonators == 0)
+        return {};
+
+    alignas (32) std::array<float, maxResonators> power;
+    for (auto k = 0; k < numResonators; k++)
+        power[(size_t) k] = stateRe[(size_t) k] * stateRe[(size_t) k] + stateIm[(size_t) k] * stateIm[(size_t) k];
+
+    const auto max = juce::FloatVectorOperations::findMaximum (power.data(), numResonators);
+    const auto peak = static_cast<int> (std::find (power.begin(), power.begin() + numResonators, max) - power.begin());
+
+    // a one-pole resonance is lorentzian, so its inverse power is a parabola in the detuning -
+    // fitting that (rather than log magnitude as for hann bins) keeps the bias to a couple of cents
+    auto position = static_cast<float> (peak);
+    auto peakPower = max;
+    if (peak > 0 && peak < numResonators - 1 && max > 0.0f)
+    {
+        constexpr auto floor = 1.0e-24f;
+        const auto left   = -1.0f / juce::jmax (floor, power[(size_t) peak - 1]);
+        const auto centre = -1.0f / max;
+        const auto right  = -1.0f / juce::jmax (floor, power[(size_t) peak + 1]);
+
+        const auto denominator = left - 2.0f * centre + right;
+        if (denominator < 0.0f)
+        {
+            const auto offset = juce::jlimit (-0.5f, 0.5f, 0.5f * (left - right) / denominator);
+            position += offset;
+            peakPower = -1.0f / juce::jmin (-1.0f / (4.0f * max), centre - 0.25f * (left - right) * offset);
+        }
+    }
+
+    return { lowestFrequency * std::exp2 (position / stepsPerOctave), 2.0f * std::sqrt (peakPower) };
+}
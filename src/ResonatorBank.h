@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    Incremental pitch tracker: a bank of damped complex resonators, one per
+    quarter tone across the guitar range. Every input sample updates all of
+    them, so a fresh estimate is available after any block instead of once
+    per filled window. State is structure-of-arrays for SIMD, like
+    OscillatorBank.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PeakDetector.h"
+
+//==============================================================================
+/**
+*/
+class ResonatorBank
+{
+public:
+    //==============================================================================
+    ResonatorBank() = default;
+
+    // message thread - places the resonators on the quarter-tone grid from lowestFreq to highestFreq
+    void prepare (double sampleRate, float lowestFreq, float highestFreq);
+    void reset() noexcept;
+
+    // advances every resonator by numSamples
+    void process (const float* samples, int numSamples) noexcept;
+
+    // strongest resonator, refined between its neighbours. magnitude is the amplitude
+    // of the sine that would produce it, so thresholds don't depend on the bandwidth
+    PeakDetector::Peak findPeak() const noexcept;
+
+    // samples until the lowest (slowest) resonator has reached 1 - 1/e of a new input
+    int getSettleSamples() const noexcept   { return settleSamples; }
+    int getNumResonators() const noexcept   { return numResonators; }
+
+    static constexpr auto stepsPerOctave = 24;      /* quarter tones */
+    static constexpr auto numLanes = 8;
+    static constexpr auto maxResonators = 13 * numLanes;
+
+private:
+    //==============================================================================
+    // one lane per resonator, padded out to whole groups of lanes with silent ones
+    alignas (32) std::array<float, maxResonators> stateRe {};
+    alignas (32) std::array<float, maxResonators> stateIm {};
+    alignas (32) std::array<float, maxResonators> poleRe {};
+    alignas (32) std::array<float, maxResonators> poleIm {};
+    alignas (32) std::array<float, maxResonators> inputGains {};
+
+    int numResonators = 0;
+    int numActiveLanes = 0;
+    int settleSamples = 0;
+    float lowestFrequency = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResonatorBank)
+};
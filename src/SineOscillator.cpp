@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    Block-based sine oscillator for the feedback tone. Phase is a wrapping
+    32-bit accumulator and the sine is an odd polynomial on the folded phase,
+    so every stage except the running phase sum is a straight vector loop.
+
+  ==============================================================================
+*/
+
+#include "SineOscillator.h"
+
+//==============================================================================
+void SineOscillator::prepare (double sampleRate) noexcept
+{
+    // a full cycle is 2^32 phase steps
+    phasePerHz = static_cast<float> (4294967296.0 / sampleRate);
+
+    // keep increments inside +-nyquist so the int32 conversion can't overflow
+    maxIncrement = 2147483520.0f;
+    reset();
+}
+
+void SineOscillator::render (const float* frequencies, float* output, int numSamples) noexcept
+{
+    while (numSamples > 0)
+    {
+        const auto num = juce::jmin (numSamples, maxChunkSize);
+
+        // frequency -> phase increment (vectorised)
+        for (auto i = 0; i < num; i++)
+            increments[(size_t) i] = static_cast<juce::int32> (juce::jlimit (-maxIncrement, maxIncrement, frequencies[i] * phasePerHz));
+
+        // running phase - the only serial step, plain integer adds that wrap for free
+        auto p = phase;
+        for (auto i = 0; i < num; i++)
+        {
+            p += static_cast<juce::uint32> (increments[(size_t) i]);
+            phases[(size_t) i] = p;
+        }
+        phase = p;
+
+        // polynomial sine (vectorised)
+        for (auto i = 0; i < num; i++)
+            output[i] = FastSine::fromPhase (phases[(size_t) i]);
+
+        frequencies += num;
+        output += num;
+        numSamples -= num;
+    }
+}
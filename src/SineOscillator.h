@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    Block-based sine oscillator for the feedback tone. Phase is a wrapping
+    32-bit accumulator and the sine is an odd polynomial on the folded phase,
+    so every stage except the running phase sum is a straight vector loop.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace FastSine
+{
+    // sin (2 pi * phase / 2^32), max error ~1e-7 over the full cycle
+    inline float fromPhase (juce::uint32 phase) noexcept
+    {
+        // signed phase in [-1, 1) stands for an angle of pi * x
+        const auto x = static_cast<float> (static_cast<juce::int32> (phase)) * (1.0f / 2147483648.0f);
+
+        // fold onto [0, 0.5] using sin (pi - a) == sin (a), put the sign back afterwards
+        const auto a = std::abs (x);
+        const auto t = std::min (a, 1.0f - a);
+        const auto t2 = t * t;
+
+        // taylor series of sin (pi t) up to t^11
+        constexpr auto c1 =  3.14159265f,  c3 = -5.16771278f,  c5 =  2.55016404f,
+                       c7 = -0.59926453f,  c9 =  0.08214589f,  c11 = -0.00737043f;
+        const auto s = t * (c1 + t2 * (c3 + t2 * (c5 + t2 * (c7 + t2 * (c9 + t2 * c11)))));
+
+        return std::copysign (s, x);
+    }
+}
+
+//==============================================================================
+/**
+*/
+class SineOscillator
+{
+public:
+    //==============================================================================
+    SineOscillator() = default;
+
+    void prepare (double sampleRate) noexcept;
+    void reset() noexcept                           { phase = 0; }
+
+    // renders numSamples of tone, frequencies holds one value in Hz per sample
+    void render (const float* frequencies, float* output, int numSamples) noexcept;
+
+    // longest run render() handles in one go, longer blocks are split internally
+    static constexpr auto maxChunkSize = 256;
+
+private:
+    //==============================================================================
+    std::array<juce::int32, maxChunkSize> increments;
+    std::array<juce::uint32, maxChunkSize> phases;
+    juce::uint32 phase = 0;
+    float phasePerHz = 0.0f;
+    float maxIncrement = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SineOscillator)
+};
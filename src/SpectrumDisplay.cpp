@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    Spectrum and tuner view for the editor. Polls the SpectrumFeed on a
+    timer, so painting never waits on the analysis, and only rebuilds its
+    path when a new frame has arrived. The spectrum is reduced to one point
+    per couple of pixels on a log frequency axis before it is drawn.
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay (SpectrumFeed& feedToShow)
+    : feed (feedToShow)
+{
+    setOpaque (true);
+
+    // the analysis only copies frames out while somebody is looking
+    feed.addViewer();
+    startTimerHz (refreshRateHz);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    stopTimer();
+    feed.removeViewer();
+}
+
+//==============================================================================
+void SpectrumDisplay::paint (juce::Graphics& g)
+{
+    g.drawImageAt (background, 0, 0);
+
+    // Tolerance's threshold - peaks under this line can't start feedback
+    g.setColour (juce::Colours::grey);
+    g.drawHorizontalLine (juce::roundToInt (decibelsToY (thresholdDecibels)), 0.0f, static_cast<float> (getWidth()));
+
+    g.setColour (juce::Colours::mediumvioletred);
+    g.strokePath (spectrumPath, juce::PathStrokeType (1.5f));
+
+    if (frequency <= 0.0f)
+        return;
+
+    g.setColour (held ? juce::Colours::lightgrey : juce::Colours::white);
+    g.drawVerticalLine (juce::roundToInt (frequencyToX (frequency)), 0.0f, static_cast<float> (getHeight()));
+
+    // tuner readout: nearest note and how far off it the pitch is
+    const auto exactNote = 69.0f + 12.0f * std::log2 (frequency / 440.0f);
+    const auto note = juce::roundToInt (exactNote);
+    const auto cents = juce::roundToInt (100.0f * (exactNote - static_cast<float> (note)));
+
+    juce::String text;
+    text << juce::MidiMessage::getMidiNoteName (note, true, true, 4) << "  "
+         << (cents >= 0 ? "+" : "") << cents << " ct  " << juce::String (frequency, 1) << " Hz";
+    if (held)
+        text << "  (held)";
+
+    g.setFont (15.0f);
+    g.drawText (text, getLocalBounds().reduced (6).removeFromTop (20), juce::Justification::topRight);
+}
+
+void SpectrumDisplay::resized()
+{
+    const auto numPoints = juce::jmax (2, getWidth() / pixelsPerPoint);
+    columnEdges.resize ((size_t) numPoints + 1);
+
+    for (auto i = 0; i <= numPoints; i++)
+        columnEdges[(size_t) i] = minFrequency * std::pow (maxFrequency / minFrequency, static_cast<float> (i) / static_cast<float> (numPoints));
+
+    drawBackground();
+    spectrumPath.clear();
+}
+
+//==============================================================================
+void SpectrumDisplay::timerCallback()
+{
+    if (! feed.fetch())
+        return;
+
+    const auto& snapshot = feed.getLatest();
+    frequency = snapshot.frequency;
+    held = snapshot.held;
+    thresholdDecibels = juce::Decibels::gainToDecibels (snapshot.threshold * snapshot.magnitudeScale, minDecibels);
+
+    // frames without a spectrum keep the last one on screen
+    if (snapshot.numBins > 0)
+        rebuildPath (snapshot);
+
+    repaint();
+}
+
+// one point per column: the loudest bin inside it, or where the column is narrower than a bin,
+// the spectrum interpolated at its centre
+void SpectrumDisplay::rebuildPath (const SpectrumFeed::Snapshot& snapshot)
+{
+    spectrumPath.clear();
+    spectrumPath.preallocateSpace (3 * static_cast<int> (columnEdges.size()));
+
+    const auto lastBin = snapshot.numBins - 1;
+    const auto toDecibels = [&] (float magnitude) { return juce::Decibels::gainToDecibels (magnitude * snapshot.magnitudeScale, minDecibels); };
+
+    for (size_t column = 0; column + 1 < columnEdges.size(); column++)
+    {
+        const auto low = columnEdges[column] / snapshot.binWidth;
+        const auto high = columnEdges[column + 1] / snapshot.binWidth;
+        auto magnitude = 0.0f;
+
+        if (static_cast<int> (high) > static_cast<int> (std::ceil (low)))
+        {
+            const auto first = juce::jmin (lastBin, static_cast<int> (std::ceil (low)));
+            const auto last = juce::jmin (lastBin, static_cast<int> (high));
+            magnitude = *std::max_element (snapshot.magnitudes.begin() + first, snapshot.magnitudes.begin() + last + 1);
+        }
+        else
+        {
+            const auto position = juce::jmin (static_cast<float> (lastBin), 0.5f * (low + high));
+            const auto bin = juce::jmin (lastBin - 1, static_cast<int> (position));
+            const auto fraction = position - static_cast<float> (bin);
+            magnitude = snapshot.magnitudes[(size_t) bin] + fraction * (snapshot.magnitudes[(size_t) bin + 1] - snapshot.magnitudes[(size_t) bin]);
+        }
+
+        const auto x = static_cast<float> (column * pixelsPerPoint);
+        const auto y = decibelsToY (toDecibels (magnitude));
+
+        if (column == 0)
+            spectrumPath.startNewSubPath (x, y);
+        else
+            spectrumPath.lineTo (x, y);
+    }
+}
+
+// the grid only changes with the size, so it's drawn once into an image
+void SpectrumDisplay::drawBackground()
+{
+    background = juce::Image (juce::Image::RGB, juce::jmax (1, getWidth()), juce::jmax (1, getHeight()), true);
+    juce::Graphics g (background);
+
+    g.fillAll (juce::Colours::black);
+    g.setFont (11.0f);
+
+    for (auto decibels = maxDecibels - 20.0f; decibels > minDecibels; decibels -= 20.0f)
+    {
+        const auto y = juce::roundToInt (decibelsToY (decibels));
+        g.setColour (juce::Colours::darkgrey.withAlpha (0.5f));
+        g.drawHorizontalLine (y, 0.0f, static_cast<float> (getWidth()));
+        g.setColour (juce::Colours::darkgrey);
+        g.drawText (juce::String (juce::roundToInt (decibels)) + " dB", 4, y - 12, 60, 12, juce::Justification::bottomLeft);
+    }
+
+    for (auto gridFrequency : { 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f })
+    {
+        const auto x = juce::roundToInt (frequencyToX (gridFrequency));
+        g.setColour (juce::Colours::darkgrey.withAlpha (0.5f));
+        g.drawVerticalLine (x, 0.0f, static_cast<float> (getHeight()));
+        g.setColour (juce::Colours::darkgrey);
+        g.drawText (gridFrequency >= 1000.0f ? juce::String (gridFrequency / 1000.0f) + "k" : juce::String (juce::roundToInt (gridFrequency)),
+                    x + 3, getHeight() - 14, 40, 12, juce::Justification::bottomLeft);
+    }
+}
+
+float SpectrumDisplay::frequencyToX (float frequencyToShow) const noexcept
+{
+    return static_cast<float> (getWidth()) * std::log (frequencyToShow / minFrequency) / std::log (maxFrequency / minFrequency);
+}
+
+float SpectrumDisplay::decibelsToY (float decibels) const noexcept
+{
+    return juce::jmap (juce::jlimit (minDecibels, maxDecibels, decibels), maxDecibels, minDecibels, 0.0f, static_cast<float> (getHeight()));
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    Spectrum and tuner view for the editor. Polls the SpectrumFeed on a
+    timer, so painting never waits on the analysis, and only rebuilds its
+    path when a new frame has arrived. The spectrum is reduced to one point
+    per couple of pixels on a log frequency axis before it is drawn.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpectrumFeed.h"
+
+//==============================================================================
+/**
+*/
+class SpectrumDisplay  : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit SpectrumDisplay (SpectrumFeed&);
+    ~SpectrumDisplay() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr auto preferredHeight = 160;
+    static constexpr auto refreshRateHz = 30;
+    static constexpr auto pixelsPerPoint = 2;
+    static constexpr auto minFrequency = 40.0f;
+    static constexpr auto maxFrequency = 5000.0f;
+    static constexpr auto minDecibels = -100.0f;
+    static constexpr auto maxDecibels = 0.0f;
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    void rebuildPath (const SpectrumFeed::Snapshot& snapshot);
+    void drawBackground();
+    float frequencyToX (float frequency) const noexcept;
+    float decibelsToY (float decibels) const noexcept;
+
+    SpectrumFeed& feed;
+
+    // frequency edges of each point's column, worked out once per size
+    std::vector<float> columnEdges;
+
+    // everything paint() needs, only touched on the message thread
+    juce::Path spectrumPath;
+    juce::Image background;
+    float thresholdDecibels = minDecibels;
+    float frequency = 0.0f;
+    bool held = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumDisplay)
+};
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    What the analysis publishes for the editor's spectrum and tuner: the
+    magnitude spectrum of the latest frame and the pitch it settled on.
+    Nothing is copied unless a display is watching.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+//==============================================================================
+/**
+*/
+class SpectrumFeed
+{
+public:
+    //==============================================================================
+    static constexpr auto maxBins = 513;    /* the positive half of the 1024 point analysis frame */
+
+    struct Snapshot
+    {
+        std::array<float, maxBins> magnitudes {};
+        int numBins = 0;                    // 0 when the frame had no spectrum (YIN, resonators, a held note)
+        float binWidth = 1.0f;              // Hz
+        float magnitudeScale = 1.0f;        // magnitude -> amplitude of the sine that would produce it
+        float threshold = 0.0f;             // Tolerance's magnitude threshold, same units as magnitudes
+        float frequency = 0.0f;             // pitch being fed back, 0 before the first one
+        bool held = false;                  // hold mode is verifying instead of analysing
+    };
+
+    SpectrumFeed() = default;
+
+    //==============================================================================
+    // message thread - displays register while they are showing
+    void addViewer() noexcept       { numViewers.fetch_add (1, std::memory_order_relaxed); }
+    void removeViewer() noexcept    { numViewers.fetch_sub (1, std::memory_order_relaxed); }
+
+    // analysis thread - skip building a snapshot when nobody looks
+    bool isWanted() const noexcept  { return numViewers.load (std::memory_order_relaxed) > 0; }
+
+    // analysis thread - fill in, then publish()
+    Snapshot& getWriteBuffer() noexcept     { return snapshots.getWriteBuffer(); }
+    void publish() noexcept                 { snapshots.publish(); }
+
+    // message thread - false if nothing new since the last call, otherwise getLatest() has changed
+    bool fetch() noexcept                   { return snapshots.fetch(); }
+    const Snapshot& getLatest() const noexcept  { return snapshots.getReadBuffer(); }
+
+private:
+    //==============================================================================
+    std::atomic<int> numViewers { 0 };
+    TripleBuffer<Snapshot> snapshots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumFeed)
+};
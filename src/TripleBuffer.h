@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    Wait-free hand-over of a whole value from one writer to one reader. The
+    writer always has a buffer of its own to fill and the reader always has
+    a complete one to look at; publishing and fetching are one atomic
+    exchange each, so neither side ever waits for the other.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    //==============================================================================
+    TripleBuffer() = default;
+
+    // writer - fill this in, then publish()
+    Type& getWriteBuffer() noexcept             { return buffers[(size_t) writeIndex]; }
+
+    // writer - hands the write buffer over and takes the spare one back
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange (writeIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // reader - swaps in the newest published value, false if nothing new has arrived since the last call
+    bool fetch() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshFlag) == 0)
+            return false;
+
+        readIndex = middle.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // reader - the value from the last successful fetch()
+    const Type& getReadBuffer() const noexcept  { return buffers[(size_t) readIndex]; }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    std::array<Type, 3> buffers {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    Time-domain YIN pitch detector. The difference function is built from an
+    FFT cross-correlation, so a frame of about two periods of the lowest note
+    costs two small transforms instead of an O(W * maxLag) loop.
+
+  ==============================================================================
+*/
+
+#include "YinDetector.h"
+
+//==============================================================================
+void YinDetector::prepare (double sampleRate, float lowestFreq, float highestFreq)
+{
+    curSampleRate = sampleRate;
+    minLag = juce::jmax (2, static_cast<int> (std::floor (sampleRate / highestFreq)));
+    maxLag = static_cast<int> (std::ceil (sampleRate / lowestFreq)) + 1;
+    windowSize = maxLag;
+
+    // circular correlation is exact for lags up to maxLag once the transform covers the whole frame
+    const auto order = juce::roundToInt (std::ceil (std::log2 (getFrameSize())));
+    fft = std::make_unique<juce::dsp::FFT> (order);
+
+    const auto fftSize = static_cast<size_t> (fft->getSize());
+    windowSpectrum.assign (fftSize * 2, 0.0f);
+    frameSpectrum.assign (fftSize * 2, 0.0f);
+    energy.assign (static_cast<size_t> (getFrameSize() + 1), 0.0f);
+    difference.assign (static_cast<size_t> (maxLag + 1), 1.0f);
+}
+
+YinDetector::Estimate YinDetector::process (const float* frame) noexcept
+{
+    computeDifference (frame);
+
+    // digital silence has no period at all
+    if (energy[(size_t) windowSize] < 1.0e-10f)
+        return {};
+
+    // absolute threshold: first local minimum whose interpolated depth is under it. Judging the
+    // interpolated value matters for short periods, where no integer lag lands near the true dip
+    auto bestLag = -1;
+    for (auto lag = juce::jmax (minLag, 1); lag < maxLag; lag++)
+    {
+        const auto d = difference[(size_t) lag];
+        if (d <= difference[(size_t) (lag - 1)] && d <= difference[(size_t) (lag + 1)]
+             && interpolatedMinimum (lag) < dipThreshold)
+        {
+            bestLag = lag;
+            break;
+        }
+    }
+
+    // nothing under the threshold - fall back to the global minimum and let the caller judge it
+    if (bestLag < 0)
+        bestLag = static_cast<int> (std::min_element (difference.begin() + minLag, difference.end()) - difference.begin());
+
+    // the interpolation needs a neighbour on each side
+    if (bestLag < minLag || bestLag >= maxLag)
+        return { 0.0f, difference[(size_t) bestLag] };
+
+    return { static_cast<float> (curSampleRate / refineLag (bestLag)), interpolatedMinimum (bestLag) };
+}
+
+//==============================================================================
+// d(tau) = sum x[j]^2 + sum x[j + tau]^2 - 2 sum x[j] x[j + tau], j over the first windowSize samples,
+// with the cross term taken from conj(FFT(window)) * FFT(frame)
+void YinDetector::computeDifference (const float* frame) noexcept
+{
+    const auto frameSize = getFrameSize();
+    const auto fftSize = fft->getSize();
+
+    std::fill (windowSpectrum.begin(), windowSpectrum.end(), 0.0f);
+    std::fill (frameSpectrum.begin(), frameSpectrum.end(), 0.0f);
+    std::copy (frame, frame + windowSize, windowSpectrum.begin());
+    std::copy (frame, frame + frameSize, frameSpectrum.begin());
+
+    fft->performRealOnlyForwardTransform (windowSpectrum.data());
+    fft->performRealOnlyForwardTransform (frameSpectrum.data());
+
+    // interleaved complex: frameSpectrum = conj(window) * frame
+    for (auto k = 0; k < fftSize; k++)
+    {
+        const auto wr = windowSpectrum[(size_t) (2 * k)], wi = windowSpectrum[(size_t) (2 * k + 1)];
+        const auto fr = frameSpectrum[(size_t) (2 * k)],  fi = frameSpectrum[(size_t) (2 * k + 1)];
+        frameSpectrum[(size_t) (2 * k)]     = wr * fr + wi * fi;
+        frameSpectrum[(size_t) (2 * k + 1)] = wr * fi - wi * fr;
+    }
+
+    fft->performRealOnlyInverseTransform (frameSpectrum.data());
+    const auto* correlation = frameSpectrum.data();
+
+    energy[0] = 0.0f;
+    for (auto i = 0; i < frameSize; i++)
+        energy[(size_t) (i + 1)] = energy[(size_t) i] + frame[i] * frame[i];
+
+    // cumulative mean normalisation, d'(0) = 1 by definition
+    const auto windowEnergy = energy[(size_t) windowSize];
+    auto runningSum = 0.0f;
+    difference[0] = 1.0f;
+
+    for (auto lag = 1; lag <= maxLag; lag++)
+    {
+        const auto shiftedEnergy = energy[(size_t) (lag + windowSize)] - energy[(size_t) lag];
+        const auto d = juce::jmax (0.0f, windowEnergy + shiftedEnergy - 2.0f * correlation[lag]);
+        runningSum += d;
+        difference[(size_t) lag] = runningSum > 0.0f ? d * static_cast<float> (lag) / runningSum : 1.0f;
+    }
+}
+
+// value at the vertex of the parabola through the minimum and its neighbours
+float YinDetector::interpolatedMinimum (int lag) const noexcept
+{
+    const auto left = difference[(size_t) (lag - 1)];
+    const auto centre = difference[(size_t) lag];
+    const auto right = difference[(size_t) (lag + 1)];
+
+    const auto denominator = left - 2.0f * centre + right;
+    if (denominator <= 0.0f)
+        return centre;
+
+    return juce::jmax (0.0f, centre - (left - right) * (left - right) / (8.0f * denominator));
+}
+
+// parabolic fit through the minimum and its neighbours
+float YinDetector::refineLag (int lag) const noexcept
+{
+    const auto left = difference[(size_t) (lag - 1)];
+    const auto centre = difference[(size_t) lag];
+    const auto right = difference[(size_t) (lag + 1)];
+
+    const auto denominator = left - 2.0f * centre + right;
+    if (denominator <= 0.0f)
+        return static_cast<float> (lag);
+
+    return static_cast<float> (lag) + juce::jlimit (-0.5f, 0.5f, 0.5f * (left - right) / denominator);
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    Time-domain YIN pitch detector. The difference function is built from an
+    FFT cross-correlation, so a frame of about two periods of the lowest note
+    costs two small transforms instead of an O(W * maxLag) loop.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+*/
+class YinDetector
+{
+public:
+    //==============================================================================
+    struct Estimate
+    {
+        float frequency = 0.0f;
+        float aperiodicity = 1.0f;      // cumulative mean normalised difference at the chosen lag, 0 = perfectly periodic
+    };
+
+    YinDetector() = default;
+
+    // message thread - sizes the frame so it holds two periods of lowestFreq
+    void prepare (double sampleRate, float lowestFreq, float highestFreq);
+
+    // number of samples process() expects, oldest first
+    int getFrameSize() const noexcept       { return windowSize + maxLag; }
+
+    Estimate process (const float* frame) noexcept;
+
+    // the first dip below this is taken as the period rather than the global minimum
+    static constexpr auto dipThreshold = 0.15f;
+
+private:
+    //==============================================================================
+    void computeDifference (const float* frame) noexcept;
+    float interpolatedMinimum (int lag) const noexcept;
+    float refineLag (int lag) const noexcept;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> windowSpectrum, frameSpectrum;
+    std::vector<float> energy;          // prefix sums of x^2 over the frame
+    std::vector<float> difference;      // cumulative mean normalised, indexed by lag
+
+    double curSampleRate = 44100.0;
+    int windowSize = 0;
+    int minLag = 1;
+    int maxLag = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (YinDetector)
+};
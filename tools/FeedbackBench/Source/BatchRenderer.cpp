@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    Renders many files through FeedbackAudioProcessor at once. Each worker
+    thread owns one processor and takes the next file from a shared queue;
+    files are streamed a chunk at a time (memory-mapped where the format
+    allows it), so nothing is ever loaded whole.
+
+    Analysis runs inline, the way OfflineRenderer's default does, and files
+    go through the same writer as "render", so a file comes out identical to
+    "render --in" with the same parameters and block size, however many
+    workers there are and whatever else the machine is doing.
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+
+//==============================================================================
+class BatchRenderer::Worker  : public juce::Thread
+{
+public:
+    // created on the calling thread, so the processor and its parameter state are too
+    Worker (const std::vector<Job>& jobsToRun, std::vector<Result>& resultsToFill, std::atomic<size_t>& queue,
+            const Setup& setupToUse, std::function<void (const Job&, const Result&)>& callback, juce::CriticalSection& callbackLock)
+        : juce::Thread ("Feedback batch"),
+          jobs (jobsToRun), results (resultsToFill), nextJob (queue),
+          setup (setupToUse), onFinished (callback), onFinishedLock (callbackLock)
+    {
+        formatManager.registerBasicFormats();
+    }
+
+    void run() override
+    {
+        for (auto index = nextJob++; index < jobs.size(); index = nextJob++)
+        {
+            // each result slot is only ever written by the worker that took its job
+            results[index] = renderFile (processor, jobs[index], setup, formatManager, chunk);
+
+            if (onFinished != nullptr)
+            {
+                const juce::ScopedLock sl (onFinishedLock);
+                onFinished (jobs[index], results[index]);
+            }
+        }
+    }
+
+private:
+    const std::vector<Job>& jobs;
+    std::vector<Result>& results;
+    std::atomic<size_t>& nextJob;
+    const Setup& setup;
+    std::function<void (const Job&, const Result&)>& onFinished;
+    juce::CriticalSection& onFinishedLock;
+
+    FeedbackAudioProcessor processor;
+    juce::AudioFormatManager formatManager;
+    juce::AudioBuffer<float> chunk;
+};
+
+//==============================================================================
+double BatchRenderer::Result::getRealtimeFactor() const noexcept
+{
+    return wallSeconds > 0.0 ? static_cast<double> (numSamples) / sampleRate / wallSeconds : 0.0;
+}
+
+std::vector<BatchRenderer::Result> BatchRenderer::run (const std::vector<Job>& jobs, const Setup& setup, int numWorkers,
+                                                       std::function<void (const Job&, const Result&)> onFinished)
+{
+    std::vector<Result> results (jobs.size());
+    std::atomic<size_t> nextJob { 0 };
+    juce::CriticalSection onFinishedLock;
+
+    // no point in workers that would find the queue already empty
+    numWorkers = juce::jlimit (1, juce::jmax (1, (int) jobs.size()), numWorkers);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < numWorkers; i++)
+        workers.push_back (std::make_unique<Worker> (jobs, results, nextJob, setup, onFinished, onFinishedLock));
+
+    for (auto& worker : workers)
+        worker->startThread();
+
+    for (auto& worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    return results;
+}
+
+//==============================================================================
+BatchRenderer::Result BatchRenderer::renderFile (FeedbackAudioProcessor& processor, const Job& job, const Setup& setup,
+                                                 juce::AudioFormatManager& formatManager, juce::AudioBuffer<float>& chunk)
+{
+    Result result;
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    auto reader = createReader (formatManager, job.input);
+    if (reader == nullptr)
+    {
+        result.error = "couldn't read " + job.input.getFullPathName();
+        return result;
+    }
+
+    const auto numChannels = static_cast<int> (reader->numChannels);
+    result.sampleRate = reader->sampleRate;
+    result.numSamples = reader->lengthInSamples;
+
+    if (! OfflineRenderer::setNumChannels (processor, numChannels))
+    {
+        result.error = "unsupported channel count " + juce::String (numChannels);
+        return result;
+    }
+
+    auto* outputFormat = formatManager.findFormatForFileExtension (job.output.getFileExtension());
+    if (outputFormat == nullptr)
+    {
+        result.error = "unknown output format " + job.output.getFileExtension();
+        return result;
+    }
+
+    auto writer = OfflineRenderer::createWriter (*outputFormat, job.output, reader->sampleRate, numChannels);
+    if (writer == nullptr)
+    {
+        result.error = "couldn't write " + job.output.getFullPathName();
+        return result;
+    }
+
+    applySetup (processor, setup);
+
+    OfflineRenderer::Settings settings;
+    settings.sampleRate = reader->sampleRate;
+    settings.blockSize = setup.blockSize;
+    settings.inlineAnalysis = true;
+    OfflineRenderer::prepare (processor, settings);
+
+    // the processor runs on past the end of the file by the latency it reports, over silence, and the first
+    // latency samples it makes are never written - so the file lines up with its source, as render's does
+    const auto latency = processor.getLatencySamples();
+    const auto streamLength = reader->lengthInSamples + latency;
+
+    // whole blocks per chunk, so processBlock sees exactly the block boundaries render() would
+    const auto blocksPerChunk = juce::jmax (1, chunkSamples / setup.blockSize);
+    const auto chunkSize = blocksPerChunk * setup.blockSize;
+    chunk.setSize (numChannels, chunkSize, false, false, true);
+
+    juce::MidiBuffer midi;
+    for (juce::int64 position = 0; position < streamLength; position += chunkSize)
+    {
+        const auto numSamples = static_cast<int> (juce::jmin ((juce::int64) chunkSize, streamLength - position));
+        const auto numFromFile = static_cast<int> (juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, reader->lengthInSamples - position));
+
+        if (numFromFile > 0 && ! reader->read (&chunk, 0, numFromFile, position, true, true))
+        {
+            result.error = "read failed at sample " + juce::String (position);
+            break;
+        }
+
+        chunk.clear (numFromFile, numSamples - numFromFile);
+
+        for (int start = 0; start < numSamples; start += setup.blockSize)
+        {
+            juce::AudioBuffer<float> block (chunk.getArrayOfWritePointers(), numChannels, start,
+                                            juce::jmin (setup.blockSize, numSamples - start));
+            processor.processBlock (block, midi);
+        }
+
+        const auto numToSkip = static_cast<int> (juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - position));
+        if (numSamples > numToSkip && ! writer->writeFromAudioSampleBuffer (chunk, numToSkip, numSamples - numToSkip))
+        {
+            result.error = "write failed at sample " + juce::String (position);
+            break;
+        }
+    }
+
+    processor.releaseResources();
+
+    result.succeeded = result.error.isEmpty();
+    result.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001;
+    return result;
+}
+
+void BatchRenderer::applySetup (FeedbackAudioProcessor& processor, const Setup& setup)
+{
+    // all of these set every parameter, so whatever the last file used is gone
+    if (setup.state.getSize() > 0)
+    {
+        processor.setStateInformation (setup.state.getData(), static_cast<int> (setup.state.getSize()));
+    }
+    else if (setup.program >= 0)
+    {
+        processor.setCurrentProgram (setup.program);
+    }
+    else
+    {
+        // what a fresh processor starts with, which is what render uses
+        for (auto* parameter : processor.getParameters())
+            parameter->setValueNotifyingHost (parameter->getDefaultValue());
+    }
+
+    for (const auto& [parameterID, value] : setup.parameters)
+        OfflineRenderer::setParameter (processor, parameterID, value);
+}
+
+std::unique_ptr<juce::AudioFormatReader> BatchRenderer::createReader (juce::AudioFormatManager& formatManager, const juce::File& file)
+{
+    auto* format = formatManager.findFormatForFileExtension (file.getFileExtension());
+    if (format == nullptr)
+        return {};
+
+    // WAV and AIFF can be mapped - pages are faulted in as the chunks walk through, nothing is copied up front
+    if (std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped { format->createMemoryMappedReader (file) })
+        if (mapped->mapEntireFile())
+            return mapped;
+
+    // anything else is read through a buffered stream, a chunk at a time
+    return std::unique_ptr<juce::AudioFormatReader> (format->createReaderFor (file.createInputStream().release(), true));
+}
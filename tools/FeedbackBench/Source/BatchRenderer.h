@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Renders many files through FeedbackAudioProcessor at once. Each worker
+    thread owns one processor and takes the next file from a shared queue;
+    files are streamed a chunk at a time (memory-mapped where the format
+    allows it), so nothing is ever loaded whole.
+
+    Analysis runs inline, the way OfflineRenderer's default does, and files
+    go through the same writer as "render", so a file comes out identical to
+    "render --in" with the same parameters and block size, however many
+    workers there are and whatever else the machine is doing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+//==============================================================================
+/**
+*/
+class BatchRenderer
+{
+public:
+    //==============================================================================
+    // applied to a worker's processor before every file, so no file sees what the previous one left behind
+    struct Setup
+    {
+        int program = -1;                   // factory preset, ignored if state is given. -1: every parameter at its default
+        juce::MemoryBlock state;            // a saved plugin state (binary or XML)
+        std::vector<std::pair<juce::String, float>> parameters;    // overrides, in each parameter's own units
+        int blockSize = 256;
+    };
+
+    struct Job
+    {
+        juce::File input;
+        juce::File output;                  // WAV or AIFF, picked by the extension
+    };
+
+    struct Result
+    {
+        bool succeeded = false;
+        juce::String error;
+        juce::int64 numSamples = 0;
+        double sampleRate = 0.0;
+        double wallSeconds = 0.0;
+
+        double getRealtimeFactor() const noexcept;
+    };
+
+    //==============================================================================
+    // renders every job with numWorkers threads and returns the results in job order.
+    // onFinished is called from the worker threads, one at a time, as each file completes
+    static std::vector<Result> run (const std::vector<Job>& jobs, const Setup& setup, int numWorkers,
+                                    std::function<void (const Job&, const Result&)> onFinished);
+
+    // streams one file through the processor - the whole of what a worker does per job
+    static Result renderFile (FeedbackAudioProcessor& processor, const Job& job, const Setup& setup,
+                              juce::AudioFormatManager& formatManager, juce::AudioBuffer<float>& chunk);
+
+    // constants
+    static constexpr auto chunkSamples = 1 << 16;   /* read and written at a time, rounded down to whole blocks */
+
+private:
+    class Worker;
+
+    static void applySetup (FeedbackAudioProcessor& processor, const Setup& setup);
+    static std::unique_ptr<juce::AudioFormatReader> createReader (juce::AudioFormatManager& formatManager, const juce::File& file);
+};
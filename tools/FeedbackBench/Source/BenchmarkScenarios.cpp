@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    Fixed benchmark scenarios and the synthetic test signals they run on.
+    Keep the list stable - the point is comparable numbers from run to run.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkScenarios.h"
+
+//==============================================================================
+namespace TestSignals
+{
+    static constexpr auto level = 0.25f;
+
+    // decaying harmonic series, roughly what a picked string looks like to the analyser
+    static void addPluck (juce::AudioBuffer<float>& buffer, double sampleRate, float frequency, int start, int length)
+    {
+        const auto end = juce::jmin (buffer.getNumSamples(), start + length);
+        const auto decay = static_cast<float> (std::exp (-3.0 / sampleRate));
+        auto envelope = level;
+
+        for (int i = start; i < end; i++)
+        {
+            const auto phase = juce::MathConstants<double>::twoPi * frequency * (i - start) / sampleRate;
+            auto sample = 0.0f;
+            for (int harmonic = 1; harmonic <= 6; harmonic++)
+                sample += static_cast<float> (std::sin (phase * harmonic)) / static_cast<float> (harmonic);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ch++)
+                buffer.addSample (ch, i, sample * envelope);
+
+            envelope *= decay;
+        }
+    }
+
+    const std::vector<float>& getPluckedNotes()
+    {
+        // open strings and a few fretted notes, so frequency glides and note changes both get exercised
+        static const std::vector<float> notes { 82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f, 440.0f, 659.26f, 987.77f };
+        return notes;
+    }
+
+    const std::vector<float>& getChordNotes()
+    {
+        // E major, open voicing
+        static const std::vector<float> notes { 82.41f, 123.47f, 164.81f, 207.65f, 246.94f, 329.63f };
+        return notes;
+    }
+
+    juce::AudioBuffer<float> makeTone (float frequency, double sampleRate, int numChannels, double seconds)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, static_cast<int> (seconds * sampleRate));
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+        {
+            const auto sample = level * static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+            for (int ch = 0; ch < numChannels; ch++)
+                buffer.setSample (ch, i, sample);
+        }
+
+        return buffer;
+    }
+
+    juce::AudioBuffer<float> makePluckedNotes (double sampleRate, int numChannels, double seconds)
+    {
+        const auto& notes = getPluckedNotes();
+
+        juce::AudioBuffer<float> buffer (numChannels, static_cast<int> (seconds * sampleRate));
+        buffer.clear();
+
+        const auto noteLength = static_cast<int> (pluckSeconds * sampleRate);
+        for (int start = 0, note = 0; start < buffer.getNumSamples(); start += noteLength, note++)
+            addPluck (buffer, sampleRate, notes[(size_t) note % notes.size()], start, noteLength);
+
+        return buffer;
+    }
+
+    juce::AudioBuffer<float> makeChord (double sampleRate, int numChannels, double seconds)
+    {
+        const auto& notes = getChordNotes();
+
+        juce::AudioBuffer<float> buffer (numChannels, static_cast<int> (seconds * sampleRate));
+        buffer.clear();
+
+        const auto chordLength = static_cast<int> (2.0 * sampleRate);
+        for (int start = 0; start < buffer.getNumSamples(); start += chordLength)
+            for (auto frequency : notes)
+                addPluck (buffer, sampleRate, frequency, start, chordLength);
+
+        buffer.applyGain (1.0f / static_cast<float> (notes.size()));
+        return buffer;
+    }
+
+    juce::AudioBuffer<float> makeNoise (double sampleRate, int numChannels, double seconds)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, static_cast<int> (seconds * sampleRate));
+        juce::Random random (0x5eed);
+
+        for (int ch = 0; ch < numChannels; ch++)
+            for (int i = 0; i < buffer.getNumSamples(); i++)
+                buffer.setSample (ch, i, level * (2.0f * random.nextFloat() - 1.0f));
+
+        return buffer;
+    }
+}
+
+//==============================================================================
+namespace BenchmarkScenarios
+{
+    const std::vector<Scenario>& getAll()
+    {
+        static const std::vector<Scenario> scenarios
+        {
+            { "baseline",       "48 kHz, 256 sample blocks, stereo linked",         48000.0, 256,  2, Input::pluckedNotes, {}, {} },
+            { "tiny-blocks",    "48 kHz, 16 sample blocks",                         48000.0, 16,   2, Input::pluckedNotes, {}, {} },
+            { "single-sample",  "48 kHz, 1 sample blocks - per-call overhead",      48000.0, 1,    1, Input::pluckedNotes, {}, {} },
+            { "odd-blocks",     "44.1 kHz, 441 sample blocks - ragged chunking",    44100.0, 441,  2, Input::pluckedNotes, {}, {} },
+            { "96k",            "96 kHz, 128 sample blocks",                        96000.0, 128,  2, Input::pluckedNotes, {}, {} },
+            { "192k",           "192 kHz, 512 sample blocks",                       192000.0, 512, 2, Input::pluckedNotes, {}, {} },
+            { "192k-tiny",      "192 kHz, 32 sample blocks",                        192000.0, 32,  2, Input::pluckedNotes, {}, {} },
+            { "quad",           "48 kHz quad, channels analysed independently",     48000.0, 256,  4, Input::pluckedNotes,
+              { { ParamIDs::ChannelMode, 1.0f } }, {} },
+            { "yin",            "48 kHz, YIN detector, 1/8 window hop",             48000.0, 64,   2, Input::pluckedNotes,
+              { { ParamIDs::Detector, 1.0f }, { ParamIDs::HopSize, 3.0f } }, {} },
+            { "resonators",     "48 kHz, resonator bank detector",                  48000.0, 64,   2, Input::pluckedNotes,
+              { { ParamIDs::Detector, 2.0f } }, {} },
+            { "poly",           "48 kHz, six voices on a strummed chord",           48000.0, 256,  2, Input::chord,
+              { { ParamIDs::Voices, 6.0f } }, {} },
+            { "noise",          "48 kHz, white noise input",                        48000.0, 256,  2, Input::noise, {}, {} },
+            { "sweep-offset",   "48 kHz, Offset swept 0..24 st, Detune -50..50",    48000.0, 128,  2, Input::pluckedNotes, {},
+              { { ParamIDs::Offset, 0.0f, 24.0f }, { ParamIDs::Detune, -50.0f, 50.0f } } },
+            { "sweep-gains",    "48 kHz, Feedback, Gain and Tolerance swept",       48000.0, 64,   2, Input::pluckedNotes, {},
+              { { ParamIDs::Feedback, 0.0f, 1.0f }, { ParamIDs::Gain, 0.0f, 1.0f }, { ParamIDs::Tolerance, 1.0f, 0.0f } } },
+            { "hold",           "48 kHz, hold mode on, 1/8 window hop",             48000.0, 256,  2, Input::pluckedNotes,
+              { { ParamIDs::Hold, 1.0f }, { ParamIDs::HopSize, 3.0f } }, {} },
+            { "lookahead",      "48 kHz, dry path delayed by the analysis latency", 48000.0, 256,  2, Input::pluckedNotes,
+              { { ParamIDs::LookAhead, 1.0f } }, {} },
+        };
+
+        return scenarios;
+    }
+
+    juce::AudioBuffer<float> createInput (const Scenario& scenario, double seconds)
+    {
+        switch (scenario.input)
+        {
+            case Input::chord:  return TestSignals::makeChord (scenario.sampleRate, scenario.numChannels, seconds);
+            case Input::noise:  return TestSignals::makeNoise (scenario.sampleRate, scenario.numChannels, seconds);
+            case Input::pluckedNotes:
+            default:            return TestSignals::makePluckedNotes (scenario.sampleRate, scenario.numChannels, seconds);
+        }
+    }
+}
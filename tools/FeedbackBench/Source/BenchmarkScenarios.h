@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    Fixed benchmark scenarios and the synthetic test signals they run on.
+    Keep the list stable - the point is comparable numbers from run to run.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+//==============================================================================
+namespace TestSignals
+{
+    // repeatable signals, all seeded or deterministic so renders can be diffed
+    juce::AudioBuffer<float> makeTone (float frequency, double sampleRate, int numChannels, double seconds);
+    juce::AudioBuffer<float> makePluckedNotes (double sampleRate, int numChannels, double seconds);
+    juce::AudioBuffer<float> makeChord (double sampleRate, int numChannels, double seconds);
+    juce::AudioBuffer<float> makeNoise (double sampleRate, int numChannels, double seconds);
+
+    // what makePluckedNotes() cycles through (a new note every pluckSeconds) and what makeChord() strums
+    const std::vector<float>& getPluckedNotes();
+    const std::vector<float>& getChordNotes();
+    static constexpr auto pluckSeconds = 0.5;
+}
+
+//==============================================================================
+namespace BenchmarkScenarios
+{
+    enum class Input
+    {
+        pluckedNotes,   // single guitar-like notes changing every half second
+        chord,          // a sustained six note chord, for the multi-voice path
+        noise           // white noise, nothing for the detectors to lock onto
+    };
+
+    struct Scenario
+    {
+        juce::String name;
+        juce::String description;
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        int numChannels = 2;
+        Input input = Input::pluckedNotes;
+        std::vector<std::pair<juce::String, float>> parameters;
+        std::vector<OfflineRenderer::ParameterSweep> sweeps;
+    };
+
+    const std::vector<Scenario>& getAll();
+
+    juce::AudioBuffer<float> createInput (const Scenario& scenario, double seconds);
+}
@@ -0,0 +1,328 @@
+/*
+  ==============================================================================
+
+    FeedbackBench - runs FeedbackAudioProcessor without a host or an editor.
+
+      render   streams a WAV file or a generated signal through the processor
+               and writes the result, with timing for every block
+      batch    renders many WAV/AIFF files with one preset, across all cores
+      bench    runs the fixed scenarios in BenchmarkScenarios.cpp
+      list     prints the scenarios
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "OfflineRenderer.h"
+#include "BatchRenderer.h"
+#include "BenchmarkScenarios.h"
+
+//==============================================================================
+static int getIntOption (const juce::ArgumentList& args, juce::StringRef option, int defaultValue)
+{
+    return args.containsOption (option) ? args.getValueForOption (option).getIntValue() : defaultValue;
+}
+
+static double getDoubleOption (const juce::ArgumentList& args, juce::StringRef option, double defaultValue)
+{
+    return args.containsOption (option) ? args.getValueForOption (option).getDoubleValue() : defaultValue;
+}
+
+// collects every "--option value" pair, for the options that may be given more than once
+static juce::StringArray getRepeatedOption (const juce::ArgumentList& args, juce::StringRef option)
+{
+    juce::StringArray values;
+    for (int i = 0; i < args.size() - 1; i++)
+        if (args[i] == option)
+            values.add (args[i + 1].text);
+
+    return values;
+}
+
+static void applyParameters (FeedbackAudioProcessor& processor, const juce::ArgumentList& args)
+{
+    for (const auto& assignment : getRepeatedOption (args, "--param"))
+    {
+        const auto parameterID = assignment.upToFirstOccurrenceOf ("=", false, false);
+        if (! OfflineRenderer::setParameter (processor, parameterID, assignment.fromFirstOccurrenceOf ("=", false, false).getFloatValue()))
+            juce::ConsoleApplication::fail ("Unknown parameter: " + parameterID);
+    }
+}
+
+static std::vector<OfflineRenderer::ParameterSweep> getSweeps (const juce::ArgumentList& args)
+{
+    std::vector<OfflineRenderer::ParameterSweep> sweeps;
+    for (const auto& sweep : getRepeatedOption (args, "--sweep"))
+    {
+        const auto range = sweep.fromFirstOccurrenceOf ("=", false, false);
+        sweeps.push_back ({ sweep.upToFirstOccurrenceOf ("=", false, false),
+                            range.upToFirstOccurrenceOf (":", false, false).getFloatValue(),
+                            range.fromFirstOccurrenceOf (":", false, false).getFloatValue() });
+    }
+
+    return sweeps;
+}
+
+static juce::AudioBuffer<float> readAudioFile (const juce::File& file, double& sampleRate)
+{
+    juce::AudioBuffer<float> buffer;
+    if (! OfflineRenderer::readFile (file, buffer, sampleRate))
+        juce::ConsoleApplication::fail ("Couldn't read " + file.getFullPathName());
+
+    return buffer;
+}
+
+static void writeAudioFile (const juce::File& file, const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    if (! OfflineRenderer::writeFile (file, buffer, sampleRate))
+        juce::ConsoleApplication::fail ("Couldn't write " + file.getFullPathName());
+}
+
+//==============================================================================
+static void render (const juce::ArgumentList& args)
+{
+    const auto outputFile = args.getFileForOption ("--out");
+    const auto numChannels = getIntOption (args, "--channels", 2);
+    const auto seconds = getDoubleOption (args, "--seconds", 10.0);
+
+    OfflineRenderer::Settings settings;
+    settings.sampleRate = getDoubleOption (args, "--rate", 48000.0);
+    settings.blockSize = getIntOption (args, "--block", 256);
+    settings.inlineAnalysis = ! args.containsOption ("--realtime");
+    settings.sweeps = getSweeps (args);
+    settings.compensateLatency = true;
+
+    juce::AudioBuffer<float> audio;
+    if (args.containsOption ("--in"))
+    {
+        // files play at their own rate, there's no resampling here
+        audio = readAudioFile (args.getExistingFileForOption ("--in"), settings.sampleRate);
+    }
+    else if (args.containsOption ("--tone"))
+    {
+        audio = TestSignals::makeTone (args.getValueForOption ("--tone").getFloatValue(), settings.sampleRate, numChannels, seconds);
+    }
+    else if (args.containsOption ("--noise"))
+    {
+        audio = TestSignals::makeNoise (settings.sampleRate, numChannels, seconds);
+    }
+    else
+    {
+        audio = TestSignals::makePluckedNotes (settings.sampleRate, numChannels, seconds);
+    }
+
+    if (settings.blockSize < 1)
+        juce::ConsoleApplication::fail ("--block must be at least 1");
+
+    FeedbackAudioProcessor processor;
+    if (! OfflineRenderer::setNumChannels (processor, audio.getNumChannels()))
+        juce::ConsoleApplication::fail ("Unsupported channel count: " + juce::String (audio.getNumChannels()));
+
+    applyParameters (processor, args);
+
+    const auto report = OfflineRenderer::render (processor, audio, settings);
+    writeAudioFile (outputFile, audio, settings.sampleRate);
+
+    std::cout << outputFile.getFullPathName() << "\n"
+              << report.toString (args.containsOption ("--histogram"));
+}
+
+// every argument after the command that isn't an option or an option's value
+static juce::Array<juce::File> getInputFiles (const juce::ArgumentList& args)
+{
+    juce::Array<juce::File> files;
+    for (int i = 1; i < args.size(); i++)
+    {
+        if (args[i].isLongOption())
+            i++;    // all of batch's options take a value
+        else
+            files.add (args[i].resolveAsFile());
+    }
+
+    return files;
+}
+
+static int findProgram (FeedbackAudioProcessor& processor, const juce::String& nameOrIndex)
+{
+    for (int i = 0; i < processor.getNumPrograms(); i++)
+        if (processor.getProgramName (i).equalsIgnoreCase (nameOrIndex) || nameOrIndex == juce::String (i))
+            return i;
+
+    juce::ConsoleApplication::fail ("Unknown preset: " + nameOrIndex);
+    return 0;
+}
+
+static void batch (const juce::ArgumentList& args)
+{
+    const auto outputFolder = args.getExistingFolderForOption ("--out-dir");
+    const auto inputFiles = getInputFiles (args);
+    if (inputFiles.isEmpty())
+        juce::ConsoleApplication::fail ("No input files");
+
+    // only used to look up presets and parameter IDs - the workers make their own
+    FeedbackAudioProcessor processor;
+
+    BatchRenderer::Setup setup;
+    setup.blockSize = getIntOption (args, "--block", 256);
+    if (setup.blockSize < 1)
+        juce::ConsoleApplication::fail ("--block must be at least 1");
+
+    if (args.containsOption ("--state"))
+    {
+        if (! args.getExistingFileForOption ("--state").loadFileAsData (setup.state))
+            juce::ConsoleApplication::fail ("Couldn't read " + args.getValueForOption ("--state"));
+    }
+    else if (args.containsOption ("--preset"))
+    {
+        setup.program = findProgram (processor, args.getValueForOption ("--preset"));
+    }
+
+    for (const auto& assignment : getRepeatedOption (args, "--param"))
+    {
+        const auto parameterID = assignment.upToFirstOccurrenceOf ("=", false, false);
+        if (processor.apvts.getParameter (parameterID) == nullptr)
+            juce::ConsoleApplication::fail ("Unknown parameter: " + parameterID);
+
+        setup.parameters.emplace_back (parameterID, assignment.fromFirstOccurrenceOf ("=", false, false).getFloatValue());
+    }
+
+    std::vector<BatchRenderer::Job> jobs;
+    for (const auto& input : inputFiles)
+    {
+        const auto output = outputFolder.getChildFile (input.getFileName());
+        if (output == input)
+            juce::ConsoleApplication::fail ("Won't overwrite " + input.getFullPathName() + " - pick another --out-dir");
+
+        jobs.push_back ({ input, output });
+    }
+
+    const auto numWorkers = getIntOption (args, "--jobs", juce::SystemStats::getNumCpus());
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    const auto results = BatchRenderer::run (jobs, setup, numWorkers, [] (const auto& job, const auto& result)
+    {
+        if (result.succeeded)
+            std::cout << job.output.getFullPathName() << "  " << juce::String (result.getRealtimeFactor(), 1) << "x realtime\n";
+        else
+            std::cout << job.input.getFullPathName() << "  FAILED: " << result.error << "\n";
+    });
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001;
+    auto audioSeconds = 0.0;
+    auto numFailed = 0;
+    for (const auto& result : results)
+    {
+        if (result.succeeded)
+            audioSeconds += static_cast<double> (result.numSamples) / result.sampleRate;
+        else
+            numFailed++;
+    }
+
+    std::cout << (int) results.size() - numFailed << " of " << (int) results.size() << " files, "
+              << juce::String (audioSeconds, 1) << " s of audio in " << juce::String (wallSeconds, 1) << " s ("
+              << juce::String (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0, 1) << "x realtime)\n";
+
+    if (numFailed > 0)
+        juce::ConsoleApplication::fail (juce::String (numFailed) + " files failed");
+}
+
+static void bench (const juce::ArgumentList& args)
+{
+    const auto seconds = getDoubleOption (args, "--seconds", 10.0);
+    const auto repeats = juce::jmax (1, getIntOption (args, "--repeat", 3));
+    const auto selected = juce::StringArray::fromTokens (args.getValueForOption ("--scenario"), ",", {});
+
+    for (const auto& scenario : BenchmarkScenarios::getAll())
+    {
+        if (! selected.isEmpty() && ! selected.contains (scenario.name))
+            continue;
+
+        OfflineRenderer::Settings settings;
+        settings.sampleRate = scenario.sampleRate;
+        settings.blockSize = scenario.blockSize;
+        settings.inlineAnalysis = ! args.containsOption ("--realtime");
+        settings.sweeps = scenario.sweeps;
+
+        const auto input = BenchmarkScenarios::createInput (scenario, seconds);
+
+        // the fastest of the repeats is the least disturbed by the rest of the machine
+        OfflineRenderer::Report best;
+        for (int run = 0; run < repeats; run++)
+        {
+            FeedbackAudioProcessor processor;
+            if (! OfflineRenderer::setNumChannels (processor, scenario.numChannels))
+                juce::ConsoleApplication::fail ("Unsupported channel count in scenario " + scenario.name);
+
+            for (const auto& [parameterID, value] : scenario.parameters)
+                OfflineRenderer::setParameter (processor, parameterID, value);
+
+            auto audio = input;
+            const auto report = OfflineRenderer::render (processor, audio, settings);
+
+            if (run == 0 || report.getNanosecondsPerSample() < best.getNanosecondsPerSample())
+                best = report;
+        }
+
+        std::cout << "[" << scenario.name << "] " << scenario.description << "\n"
+                  << best.toString (args.containsOption ("--histogram")) << "\n";
+    }
+}
+
+static void list (const juce::ArgumentList&)
+{
+    for (const auto& scenario : BenchmarkScenarios::getAll())
+        std::cout << scenario.name.paddedRight (' ', 16) << scenario.description << "\n";
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter state wants a message manager, even though nothing here runs a message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand ("--help|-h", "FeedbackBench - offline render and benchmark tool for the Feedback plugin", true);
+
+    app.addCommand ({ "render",
+                      "render --out <file.wav> [--in <file.wav> | --tone <Hz> | --noise] [options]",
+                      "Streams audio through the processor and writes the result",
+                      "Without --in a generated signal is used (plucked notes unless --tone or --noise is given).\n"
+                      "The output lines up with the input: any latency the processor reports (look-ahead) is trimmed off.\n"
+                      "  --rate <Hz>            sample rate for generated input (default 48000)\n"
+                      "  --block <samples>      block size (default 256)\n"
+                      "  --channels <n>         1, 2 or 4 channels for generated input (default 2)\n"
+                      "  --seconds <s>          length of generated input (default 10)\n"
+                      "  --param <ID>=<value>   sets a parameter in its own units, may be repeated\n"
+                      "  --sweep <ID>=<a>:<b>   moves a parameter from a to b over the render, may be repeated\n"
+                      "  --realtime             analyse on the worker thread like a live host (output not repeatable)\n"
+                      "  --histogram            prints the distribution of per-block times",
+                      render });
+
+    app.addCommand ({ "batch",
+                      "batch --out-dir <folder> [--preset <name|index> | --state <file>] [options] <file>...",
+                      "Renders WAV/AIFF files in parallel and writes them to --out-dir under the same names",
+                      "Each worker thread runs its own processor; files are streamed in chunks, not loaded whole.\n"
+                      "Like render, the output lines up with the input, with any reported latency trimmed off.\n"
+                      "Analysis runs inline and files are written the way render writes them (24 bit, no metadata), so with\n"
+                      "neither --preset nor --state every file matches \"render --in\" at the same block size and --params.\n"
+                      "  --preset <name|index>  factory preset (default: none, every parameter at its default like render)\n"
+                      "  --state <file>         saved plugin state to use instead of a preset\n"
+                      "  --param <ID>=<value>   overrides a parameter after the preset, may be repeated\n"
+                      "  --block <samples>      block size (default 256)\n"
+                      "  --jobs <n>             worker threads (default: one per core)",
+                      batch });
+
+    app.addCommand ({ "bench",
+                      "bench [--scenario <name,...>] [--seconds <s>] [--repeat <n>] [--realtime] [--histogram]",
+                      "Runs the fixed benchmark scenarios",
+                      "Reports the fastest of --repeat runs (default 3) of --seconds of audio (default 10).\n"
+                      "The pitch analysis runs inside processBlock and is timed with it, the way render does by default.\n"
+                      "--realtime leaves it on the worker threads and times only the audio thread's share - blocks still\n"
+                      "arrive faster than realtime, so the workers may drop input; the report says when they have.",
+                      bench });
+
+    app.addCommand ({ "list", "list", "Lists the benchmark scenarios", {}, list });
+
+    return app.findAndRunCommand (argc, argv);
+}
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    Streams a buffer through FeedbackAudioProcessor a block at a time, the way
+    a host would, and times every processBlock call.
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+//==============================================================================
+double OfflineRenderer::Report::getTotalNanoseconds() const noexcept
+{
+    return std::accumulate (blockNanoseconds.begin(), blockNanoseconds.end(), 0.0);
+}
+
+double OfflineRenderer::Report::getNanosecondsPerSample() const noexcept
+{
+    return numSamples > 0 ? getTotalNanoseconds() / static_cast<double> (numSamples) : 0.0;
+}
+
+double OfflineRenderer::Report::getWorstBlockNanoseconds() const noexcept
+{
+    return blockNanoseconds.empty() ? 0.0 : *std::max_element (blockNanoseconds.begin(), blockNanoseconds.end());
+}
+
+double OfflineRenderer::Report::getPercentile (double percent) const
+{
+    if (blockNanoseconds.empty())
+        return 0.0;
+
+    auto sorted = blockNanoseconds;
+    const auto index = juce::jlimit ((size_t) 0, sorted.size() - 1,
+                                     static_cast<size_t> (percent / 100.0 * static_cast<double> (sorted.size() - 1) + 0.5));
+    std::nth_element (sorted.begin(), sorted.begin() + (std::ptrdiff_t) index, sorted.end());
+    return sorted[index];
+}
+
+juce::String OfflineRenderer::Report::toString (bool withHistogram) const
+{
+    const auto audioNanoseconds = static_cast<double> (numSamples) / sampleRate * 1.0e9;
+    const auto blockBudget = static_cast<double> (blockSize) / sampleRate * 1.0e9;
+
+    juce::String text;
+    text << numSamples << " samples in " << (int) blockNanoseconds.size() << " blocks: "
+         << juce::String (getNanosecondsPerSample(), 2) << " ns/sample, "
+         << juce::String (100.0 * getTotalNanoseconds() / audioNanoseconds, 3) << "% of realtime" << juce::newLine
+         << "block us  p50 " << juce::String (getPercentile (50.0) * 1.0e-3, 2)
+         << "  p90 " << juce::String (getPercentile (90.0) * 1.0e-3, 2)
+         << "  p99 " << juce::String (getPercentile (99.0) * 1.0e-3, 2)
+         << "  p99.9 " << juce::String (getPercentile (99.9) * 1.0e-3, 2)
+         << "  worst " << juce::String (getWorstBlockNanoseconds() * 1.0e-3, 2)
+         << " (" << juce::String (100.0 * getWorstBlockNanoseconds() / blockBudget, 2) << "% of the block budget)" << juce::newLine;
+
+    const auto numFrames = holdStats.framesAnalysed + holdStats.framesSkipped;
+    if (numFrames > 0)
+        text << "analysis frames  " << (int) holdStats.framesAnalysed << " run, " << (int) holdStats.framesSkipped << " held ("
+             << juce::String (100.0 * holdStats.framesSkipped / numFrames, 1) << "% skipped)" << juce::newLine;
+
+    // the detectors saw less than a host would have given them, so their state and cost aren't a real session's
+    if (droppedAnalysisSamples > 0)
+        text << "WARNING: " << droppedAnalysisSamples << " analysis input samples dropped - the workers couldn't keep up "
+             << "with blocks fed faster than realtime" << juce::newLine;
+
+    if (! withHistogram || blockNanoseconds.empty())
+        return text;
+
+    // power-of-two buckets of per-block cost, so a handful of slow blocks stand out from the bulk
+    constexpr auto numBuckets = 24;
+    std::array<int, numBuckets> counts {};
+    for (auto ns : blockNanoseconds)
+        counts[(size_t) juce::jlimit (0, numBuckets - 1, static_cast<int> (std::log2 (juce::jmax (1.0, ns))))]++;
+
+    const auto largest = *std::max_element (counts.begin(), counts.end());
+    for (auto bucket = 0; bucket < numBuckets; bucket++)
+    {
+        if (counts[(size_t) bucket] == 0)
+            continue;
+
+        const auto barLength = juce::jmax (1, counts[(size_t) bucket] * 40 / largest);
+        text << juce::String ((double) (1 << bucket) * 1.0e-3, 3).paddedLeft (' ', 10) << " us+ | "
+             << juce::String::repeatedString ("#", barLength) << " " << counts[(size_t) bucket] << juce::newLine;
+    }
+
+    return text;
+}
+
+//==============================================================================
+bool OfflineRenderer::setNumChannels (FeedbackAudioProcessor& processor, int numChannels)
+{
+    auto layout = processor.getBusesLayout();
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+    layout.getMainInputChannelSet() = channelSet;
+    layout.getMainOutputChannelSet() = channelSet;
+    return processor.setBusesLayout (layout);
+}
+
+bool OfflineRenderer::setParameter (FeedbackAudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    auto* parameter = processor.apvts.getParameter (parameterID);
+    if (parameter == nullptr)
+        return false;
+
+    parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    return true;
+}
+
+void OfflineRenderer::prepare (FeedbackAudioProcessor& processor, const Settings& settings)
+{
+    processor.setNonRealtime (settings.inlineAnalysis);
+    processor.setRateAndBufferSizeDetails (settings.sampleRate, settings.blockSize);
+    processor.prepareToPlay (settings.sampleRate, settings.blockSize);
+}
+
+OfflineRenderer::Report OfflineRenderer::render (FeedbackAudioProcessor& processor, juce::AudioBuffer<float>& audio, const Settings& settings)
+{
+    prepare (processor, settings);
+
+    // with compensation, the input plus a tail of silence goes through, so the delayed end of the input comes out too
+    const auto latency = settings.compensateLatency ? processor.getLatencySamples() : 0;
+    juce::AudioBuffer<float> padded;
+    auto* stream = &audio;
+
+    if (latency > 0)
+    {
+        padded.setSize (audio.getNumChannels(), audio.getNumSamples() + latency);
+        for (int ch = 0; ch < audio.getNumChannels(); ch++)
+            padded.copyFrom (ch, 0, audio, ch, 0, audio.getNumSamples());
+
+        padded.clear (audio.getNumSamples(), latency);
+        stream = &padded;
+    }
+
+    Report report;
+    report.sampleRate = settings.sampleRate;
+    report.blockSize = settings.blockSize;
+    report.numSamples = stream->getNumSamples();
+    report.blockNanoseconds.reserve ((size_t) (stream->getNumSamples() / settings.blockSize + 1));
+
+    juce::MidiBuffer midi;
+    const auto ticksToNanoseconds = 1.0e9 / static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+
+    for (int start = 0; start < stream->getNumSamples(); start += settings.blockSize)
+    {
+        const auto numSamples = juce::jmin (settings.blockSize, stream->getNumSamples() - start);
+        const auto position = static_cast<float> (start) / static_cast<float> (juce::jmax (1, stream->getNumSamples() - 1));
+
+        for (const auto& sweep : settings.sweeps)
+            setParameter (processor, sweep.parameterID, sweep.start + (sweep.end - sweep.start) * position);
+
+        // a view onto the next block - no copy, the processor writes straight into the buffer
+        juce::AudioBuffer<float> block (stream->getArrayOfWritePointers(), stream->getNumChannels(), start, numSamples);
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock (block, midi);
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+
+        report.blockNanoseconds.push_back (static_cast<double> (endTicks - startTicks) * ticksToNanoseconds);
+
+        if (settings.afterBlock != nullptr)
+            settings.afterBlock (start + numSamples);
+    }
+
+    // the first latency samples are what the processor made of nothing
+    if (latency > 0)
+        for (int ch = 0; ch < audio.getNumChannels(); ch++)
+            audio.copyFrom (ch, 0, padded, ch, latency, audio.getNumSamples());
+
+    processor.releaseResources();
+    report.holdStats = processor.getHoldStats();
+    report.droppedAnalysisSamples = processor.getNumDroppedAnalysisSamples();
+    return report;
+}
+
+//==============================================================================
+std::unique_ptr<juce::AudioFormatWriter> OfflineRenderer::createWriter (juce::AudioFormat& format, const juce::File& file,
+                                                                        double sampleRate, int numChannels)
+{
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+    if (stream == nullptr)
+        return {};
+
+    // no metadata either, so nothing of the input's makes its way into the file
+    std::unique_ptr<juce::AudioFormatWriter> writer (format.createWriterFor (stream.get(), sampleRate, static_cast<unsigned int> (numChannels),
+                                                                             outputBitDepth, {}, 0));
+    if (writer != nullptr)
+        stream.release();   // the writer owns it now
+
+    return writer;
+}
+
+bool OfflineRenderer::readFile (const juce::File& file, juce::AudioBuffer<float>& dest, double& sampleRate)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr)
+        return false;
+
+    dest.setSize (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+    sampleRate = reader->sampleRate;
+    return reader->read (&dest, 0, dest.getNumSamples(), 0, true, true);
+}
+
+bool OfflineRenderer::writeFile (const juce::File& file, const juce::AudioBuffer<float>& source, double sampleRate)
+{
+    juce::WavAudioFormat wavFormat;
+    auto writer = createWriter (wavFormat, file, sampleRate, source.getNumChannels());
+    return writer != nullptr && writer->writeFromAudioSampleBuffer (source, 0, source.getNumSamples());
+}
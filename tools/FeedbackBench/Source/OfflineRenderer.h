@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    Streams a buffer through FeedbackAudioProcessor a block at a time, the way
+    a host would, and times every processBlock call.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../src/PluginProcessor.h"
+
+//==============================================================================
+/**
+*/
+class OfflineRenderer
+{
+public:
+    //==============================================================================
+    // moves a parameter linearly from start to end over the length of the render
+    struct ParameterSweep
+    {
+        juce::String parameterID;
+        float start = 0.0f;
+        float end = 0.0f;
+    };
+
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+
+        // non-realtime: analysis runs inside processBlock, so the output is repeatable and its cost is timed.
+        // realtime: analysis stays on the worker thread and only the audio thread's share is timed
+        bool inlineAnalysis = true;
+        std::vector<ParameterSweep> sweeps;
+
+        // output lined up with the input, for rendering files: the processor also runs over as much silence
+        // as the latency it reports, and the output is read back from that many samples in
+        bool compensateLatency = false;
+
+        // called after every block (outside the timing) with the number of samples rendered so far
+        std::function<void (int)> afterBlock;
+    };
+
+    struct Report
+    {
+        juce::int64 numSamples = 0;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        std::vector<double> blockNanoseconds;   // one entry per processBlock call, in order
+        PitchAnalyser::HoldStats holdStats;     // analysis frames run and skipped over the render
+        juce::int64 droppedAnalysisSamples = 0; // input the workers fell too far behind to take - always 0 inline
+
+        double getTotalNanoseconds() const noexcept;
+        double getNanosecondsPerSample() const noexcept;
+        double getWorstBlockNanoseconds() const noexcept;
+        double getPercentile (double percent) const;
+
+        // one summary line plus a per-block distribution
+        juce::String toString (bool withHistogram) const;
+    };
+
+    //==============================================================================
+    // sets the main bus to numChannels in and out - false if the processor won't take it
+    static bool setNumChannels (FeedbackAudioProcessor& processor, int numChannels);
+
+    // sets a parameter in its own units (dB, semitones, choice index...), false if the ID is unknown
+    static bool setParameter (FeedbackAudioProcessor& processor, const juce::String& parameterID, float value);
+
+    // puts the processor in the state render() starts from: rate, block size, analysis mode, all history cleared
+    static void prepare (FeedbackAudioProcessor& processor, const Settings& settings);
+
+    // processes audio in place - prepares the processor first and releases it afterwards
+    static Report render (FeedbackAudioProcessor& processor, juce::AudioBuffer<float>& audio, const Settings& settings);
+
+    //==============================================================================
+    // a writer for a rendered file in the given format, null if the file can't be opened. render and batch
+    // both write through this, so the same input gives the same file whichever command made it
+    static std::unique_ptr<juce::AudioFormatWriter> createWriter (juce::AudioFormat& format, const juce::File& file,
+                                                                  double sampleRate, int numChannels);
+
+    // the whole of a file into a buffer, false if it can't be read
+    static bool readFile (const juce::File& file, juce::AudioBuffer<float>& dest, double& sampleRate);
+
+    // a buffer to a WAV file, false if it can't be written
+    static bool writeFile (const juce::File& file, const juce::AudioBuffer<float>& source, double sampleRate);
+
+    // constants
+    static constexpr auto outputBitDepth = 24;      /* whatever the input had */
+};
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    FeedbackBench's batch command has to write exactly what "render --in"
+    writes for the same file and parameters. Both are run here on inputs
+    of different bit depths, and the two output files are compared sample
+    for sample. With look-ahead on, both have to line up with their source.
+
+  ==============================================================================
+*/
+
+#include "TestHelpers.h"
+#include "../../FeedbackBench/Source/BatchRenderer.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+    struct BatchCase
+    {
+        const char* name;
+        ParameterList parameters;
+    };
+
+    const BatchCase batchCases[] { { "defaults", {} },
+                                   { "octave", { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Offset, 12.0f } } },
+                                   { "look-ahead", { { ParamIDs::Feedback, 0.5f }, { ParamIDs::LookAhead, 1.0f } } } };
+
+    const int inputBitDepths[] { 16, 24, 32 };
+
+    constexpr auto inputSampleRate = 44100.0;
+    constexpr auto inputSeconds = 2.0;
+}
+
+//==============================================================================
+class BatchRenderTest  : public juce::UnitTest
+{
+public:
+    BatchRenderTest() : juce::UnitTest ("Batch matches render", "Batch") {}
+
+    void runTest() override
+    {
+        if (formatManager.getNumKnownFormats() == 0)
+            formatManager.registerBasicFormats();
+
+        const auto folder = juce::File::getSpecialLocation (juce::File::tempDirectory).getNonexistentChildFile ("FeedbackTests-batch", {});
+        folder.createDirectory();
+
+        for (const auto& batchCase : batchCases)
+        {
+            for (auto bitDepth : inputBitDepths)
+            {
+                beginTest (juce::String (batchCase.name) + ", " + juce::String (bitDepth) + " bit input");
+
+                const auto input = folder.getChildFile ("input.wav");
+                const auto fromBatch = folder.getChildFile ("batch.wav");
+                const auto fromRender = folder.getChildFile ("render.wav");
+
+                expect (writeInput (input, bitDepth), "couldn't write " + input.getFullPathName());
+                renderWithBatch (input, fromBatch, batchCase.parameters);
+                renderWithRender (input, fromRender, batchCase.parameters);
+
+                expectEquals (fromBatch.getSize(), fromRender.getSize(), "file size");
+                expectIdentical (fromBatch, fromRender);
+            }
+        }
+
+        // look-ahead delays the dry path by the reported latency - with no tone added, a file that
+        // lines up with its source is its source, down to the last sample
+        beginTest ("Look-ahead output lines up with the input");
+        {
+            const auto input = folder.getChildFile ("input.wav");
+            const auto fromBatch = folder.getChildFile ("batch.wav");
+            const auto fromRender = folder.getChildFile ("render.wav");
+            const ParameterList parameters { { ParamIDs::LookAhead, 1.0f } };
+
+            expect (writeInput (input, OfflineRenderer::outputBitDepth), "couldn't write " + input.getFullPathName());
+            renderWithBatch (input, fromBatch, parameters);
+            renderWithRender (input, fromRender, parameters);
+
+            expectIdentical (fromBatch, input);
+            expectIdentical (fromRender, input);
+        }
+
+        folder.deleteRecursively();
+    }
+
+private:
+    bool writeInput (const juce::File& file, int bitDepth)
+    {
+        const auto audio = TestSignals::makePluckedNotes (inputSampleRate, 2, inputSeconds);
+
+        file.deleteFile();
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wavFormat.createWriterFor (new juce::FileOutputStream (file), inputSampleRate,
+                                                                                     static_cast<unsigned int> (audio.getNumChannels()),
+                                                                                     bitDepth, {}, 0));
+        return writer != nullptr && writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+    }
+
+    // what the batch command does with a file, on one worker's processor
+    void renderWithBatch (const juce::File& input, const juce::File& output, const ParameterList& parameters)
+    {
+        BatchRenderer::Setup setup;
+        setup.blockSize = defaultBlockSize;
+        setup.parameters = parameters;
+
+        FeedbackAudioProcessor processor;
+        juce::AudioBuffer<float> chunk;
+        const auto result = BatchRenderer::renderFile (processor, { input, output }, setup, formatManager, chunk);
+        expect (result.succeeded, "batch: " + result.error);
+    }
+
+    // what the render command does with --in
+    void renderWithRender (const juce::File& input, const juce::File& output, const ParameterList& parameters)
+    {
+        OfflineRenderer::Settings settings;
+        settings.blockSize = defaultBlockSize;
+        settings.compensateLatency = true;
+
+        juce::AudioBuffer<float> audio;
+        expect (OfflineRenderer::readFile (input, audio, settings.sampleRate), "couldn't read " + input.getFullPathName());
+
+        auto processor = createProcessor (audio.getNumChannels(), parameters);
+        OfflineRenderer::render (*processor, audio, settings);
+        expect (OfflineRenderer::writeFile (output, audio, settings.sampleRate), "couldn't write " + output.getFullPathName());
+    }
+
+    void expectIdentical (const juce::File& first, const juce::File& second)
+    {
+        juce::AudioBuffer<float> a, b;
+        auto rateA = 0.0, rateB = 0.0;
+        expect (OfflineRenderer::readFile (first, a, rateA) && OfflineRenderer::readFile (second, b, rateB), "couldn't read the renders back");
+
+        expectEquals (rateA, rateB, "sample rate");
+        expectEquals (a.getNumChannels(), b.getNumChannels(), "channel count");
+        expectEquals (a.getNumSamples(), b.getNumSamples(), "length");
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+            return;
+
+        // the first sample that differs, so a failure says where the two went apart
+        for (int ch = 0; ch < a.getNumChannels(); ch++)
+        {
+            for (int i = 0; i < a.getNumSamples(); i++)
+            {
+                if (a.getSample (ch, i) != b.getSample (ch, i))
+                {
+                    expect (false, "first difference at channel " + juce::String (ch) + ", sample " + juce::String (i));
+                    return;
+                }
+            }
+        }
+    }
+
+    juce::AudioFormatManager formatManager;
+};
+
+static BatchRenderTest batchRenderTest;
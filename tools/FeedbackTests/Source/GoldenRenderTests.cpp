@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    Renders fixed inputs and compares them with the renders stored in the
+    Golden folder. A change that is meant to alter the output re-records
+    them with --record; anything else that moves a sample past the
+    tolerance fails, and so does a golden that isn't there.
+
+    Every case is also rendered twice and has to come out bit-identical.
+
+  ==============================================================================
+*/
+
+#include "TestHelpers.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+    struct GoldenCase
+    {
+        const char* name;
+        BenchmarkScenarios::Input input;
+        int numChannels;
+        ParameterList parameters;
+    };
+
+    const std::vector<GoldenCase>& getGoldenCases()
+    {
+        using Input = BenchmarkScenarios::Input;
+
+        static const std::vector<GoldenCase> cases
+        {
+            { "plucked-fft",        Input::pluckedNotes, 2, { { ParamIDs::Feedback, 0.5f } } },
+            { "plucked-yin",        Input::pluckedNotes, 2, { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Detector, 1.0f } } },
+            { "plucked-resonators", Input::pluckedNotes, 2, { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Detector, 2.0f } } },
+            { "plucked-hold",       Input::pluckedNotes, 2, { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Hold, 1.0f } } },
+            { "plucked-lookahead",  Input::pluckedNotes, 2, { { ParamIDs::Feedback, 0.5f }, { ParamIDs::LookAhead, 1.0f } } },
+            { "chord-poly",         Input::chord,        2, { { ParamIDs::Feedback, 0.5f }, { ParamIDs::Voices, 6.0f } } },
+            { "quad-independent",   Input::pluckedNotes, 4, { { ParamIDs::Feedback, 0.5f }, { ParamIDs::ChannelMode, 1.0f } } },
+            { "noise",              Input::noise,        2, { { ParamIDs::Feedback, 0.5f } } },
+        };
+
+        return cases;
+    }
+
+    constexpr auto renderSeconds = 3.0;
+    constexpr auto maxSampleError = 1.0e-4f;    /* -80 dB - room for compiler and SIMD rounding, not for a behaviour change */
+}
+
+//==============================================================================
+class GoldenRenderTest  : public juce::UnitTest
+{
+public:
+    GoldenRenderTest() : juce::UnitTest ("Golden renders", "Golden") {}
+
+    void runTest() override
+    {
+        if (formatManager.getNumKnownFormats() == 0)
+            formatManager.registerBasicFormats();
+
+        for (const auto& goldenCase : getGoldenCases())
+        {
+            beginTest (goldenCase.name);
+
+            BenchmarkScenarios::Scenario scenario;
+            scenario.numChannels = goldenCase.numChannels;
+            scenario.input = goldenCase.input;
+
+            const auto input = BenchmarkScenarios::createInput (scenario, renderSeconds);
+            auto audio = renderCase (goldenCase, input);
+
+            // a fresh processor on the same input - anything left uninitialised or racing shows up here
+            const auto repeat = renderCase (goldenCase, input);
+            expectWithinError (audio, repeat, 0.0f, "second render differs");
+
+            const auto file = getOptions().goldenFolder.getChildFile (juce::String (goldenCase.name) + ".wav");
+
+            if (getOptions().record)
+            {
+                expect (writeGolden (file, audio), "couldn't write " + file.getFullPathName());
+                logMessage ("recorded " + file.getFullPathName());
+                continue;
+            }
+
+            compareWithGolden (file, audio);
+        }
+    }
+
+private:
+    static juce::AudioBuffer<float> renderCase (const GoldenCase& goldenCase, const juce::AudioBuffer<float>& input)
+    {
+        auto audio = input;
+        auto processor = createProcessor (goldenCase.numChannels, goldenCase.parameters);
+        render (*processor, audio, defaultSampleRate, defaultBlockSize);
+        return audio;
+    }
+
+    bool writeGolden (const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        file.getParentDirectory().createDirectory();
+        file.deleteFile();
+
+        // 32 bit float, so the comparison sees exactly what the processor wrote
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wavFormat.createWriterFor (new juce::FileOutputStream (file), defaultSampleRate,
+                                                                                     static_cast<unsigned int> (audio.getNumChannels()),
+                                                                                     32, {}, 0));
+        return writer != nullptr && writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+    }
+
+    void compareWithGolden (const juce::File& file, const juce::AudioBuffer<float>& audio)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+        expect (reader != nullptr, "no golden render at " + file.getFullPathName() + " - record one with --record");
+        if (reader == nullptr)
+            return;
+
+        expectEquals ((int) reader->numChannels, audio.getNumChannels(), "channel count");
+        expectEquals ((int) reader->lengthInSamples, audio.getNumSamples(), "length");
+        if ((int) reader->numChannels != audio.getNumChannels() || (int) reader->lengthInSamples != audio.getNumSamples())
+            return;
+
+        juce::AudioBuffer<float> golden (audio.getNumChannels(), audio.getNumSamples());
+        reader->read (&golden, 0, golden.getNumSamples(), 0, true, true);
+
+        expectWithinError (audio, golden, maxSampleError, "golden render differs");
+    }
+
+    void expectWithinError (const juce::AudioBuffer<float>& audio, const juce::AudioBuffer<float>& reference,
+                            float allowedError, const juce::String& what)
+    {
+        // worst sample and where it is, so a failure says whether it's one click or the whole render
+        auto maxError = 0.0f;
+        auto worstChannel = 0;
+        auto worstSample = 0;
+        for (int ch = 0; ch < audio.getNumChannels(); ch++)
+        {
+            for (int i = 0; i < audio.getNumSamples(); i++)
+            {
+                const auto error = std::abs (audio.getSample (ch, i) - reference.getSample (ch, i));
+                if (error > maxError)
+                {
+                    maxError = error;
+                    worstChannel = ch;
+                    worstSample = i;
+                }
+            }
+        }
+
+        expectLessOrEqual (maxError, allowedError,
+                           what + ": max error " + juce::String (juce::Decibels::gainToDecibels (maxError), 1) + " dB at channel "
+                             + juce::String (worstChannel) + ", sample " + juce::String (worstSample));
+    }
+
+    juce::AudioFormatManager formatManager;
+};
+
+static GoldenRenderTest goldenRenderTest;
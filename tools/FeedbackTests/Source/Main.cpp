@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    FeedbackTests - regression and performance checks for the DSP path.
+
+      FeedbackTests [--category <Pitch|Golden|Performance|Batch>] [options]
+
+      --record               writes the golden renders and CPU budgets instead of checking
+                             against them - a missing recording is otherwise a failure
+      --golden <folder>      where both live. Without it, the Golden folder next to FeedbackTests.jucer
+                             in the first directory above the executable that has one
+      --budget-scale <x>     multiplies the CPU budgets, for slower machines
+      --skip-performance     leaves out the CPU budgets
+
+    Exits with 1 if anything failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "TestHelpers.h"
+
+//==============================================================================
+// the project's own folder, found by walking up from the executable - builds land somewhere below it
+static juce::File findDefaultGoldenFolder()
+{
+    for (auto folder = juce::File::getSpecialLocation (juce::File::currentExecutableFile).getParentDirectory();
+         folder != folder.getParentDirectory(); folder = folder.getParentDirectory())
+    {
+        if (folder.getChildFile ("FeedbackTests.jucer").existsAsFile())
+            return folder.getChildFile ("Golden");
+    }
+
+    return {};
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processor's parameter state wants a message manager, even though nothing here runs a message loop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args (argc, argv);
+
+    auto& options = TestHelpers::getOptions();
+    options.record = args.containsOption ("--record");
+    options.goldenFolder = args.containsOption ("--golden") ? args.getFileForOption ("--golden") : findDefaultGoldenFolder();
+    options.budgetScale = args.containsOption ("--budget-scale") ? args.getValueForOption ("--budget-scale").getDoubleValue() : 1.0;
+    options.skipPerformance = args.containsOption ("--skip-performance");
+
+    // a copied executable has no project above it to find the fixtures in
+    if (options.goldenFolder == juce::File())
+    {
+        std::cerr << "Couldn't find FeedbackTests.jucer above the executable - pass --golden <folder>" << std::endl;
+        return 1;
+    }
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+
+    if (args.containsOption ("--category"))
+        runner.runTestsInCategory (args.getValueForOption ("--category"));
+    else
+        runner.runAllTests();
+
+    auto numFailures = 0;
+    for (int i = 0; i < runner.getNumResults(); i++)
+        numFailures += runner.getResult (i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    CPU budgets for every benchmark scenario, in nanoseconds per sample with
+    the analysis folded into processBlock. The budgets are measurements,
+    not guesses: --record times every scenario on the reference machine
+    and writes the results to cpu-budgets.json in the Golden folder, and a
+    later run fails any scenario that is more than budgetMargin slower than
+    its recording, or that has no recording. A kernel that gets faster is
+    re-recorded to tighten its budget. Debug builds don't run these.
+
+  ==============================================================================
+*/
+
+#include "TestHelpers.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+    // the best of three runs moves by about 10% between sessions on an otherwise idle machine,
+    // so a scenario has to be a quarter slower than its recording before it counts as a regression
+    constexpr auto budgetMargin = 1.25;
+
+    constexpr auto renderSeconds = 5.0;
+    constexpr auto numRepeats = 3;      /* the fastest run counts, it's the least disturbed by the rest of the machine */
+}
+
+//==============================================================================
+class PerformanceBudgetTest  : public juce::UnitTest
+{
+public:
+    PerformanceBudgetTest() : juce::UnitTest ("CPU budgets", "Performance") {}
+
+    void runTest() override
+    {
+       #if JUCE_DEBUG
+        beginTest ("Skipped");
+        logMessage ("CPU budgets only mean something in an optimised build");
+       #else
+        if (getOptions().skipPerformance)
+            return;
+
+        const auto budgetFile = getOptions().goldenFolder.getChildFile ("cpu-budgets.json");
+        const auto recorded = juce::JSON::parse (budgetFile);
+        auto measured = std::make_unique<juce::DynamicObject>();
+
+        for (const auto& scenario : BenchmarkScenarios::getAll())
+        {
+            beginTest (scenario.name);
+
+            const auto budget = static_cast<double> (recorded[juce::Identifier (scenario.name)]);
+            if (! getOptions().record && budget <= 0.0)
+            {
+                expect (false, "no CPU budget recorded in " + budgetFile.getFullPathName() + " - record one with --record");
+                continue;
+            }
+
+            OfflineRenderer::Settings settings;
+            settings.sampleRate = scenario.sampleRate;
+            settings.blockSize = scenario.blockSize;
+            settings.inlineAnalysis = true;
+            settings.sweeps = scenario.sweeps;
+
+            const auto input = BenchmarkScenarios::createInput (scenario, renderSeconds);
+
+            auto best = std::numeric_limits<double>::max();
+            for (int run = 0; run < numRepeats; run++)
+            {
+                auto processor = createProcessor (scenario.numChannels, scenario.parameters);
+                auto audio = input;
+                best = juce::jmin (best, OfflineRenderer::render (*processor, audio, settings).getNanosecondsPerSample());
+            }
+
+            if (getOptions().record)
+            {
+                measured->setProperty (juce::Identifier (scenario.name), juce::roundToInt (best * 10.0) / 10.0);
+                logMessage (juce::String (best, 1) + " ns/sample recorded");
+                continue;
+            }
+
+            const auto allowed = budget * budgetMargin * getOptions().budgetScale;
+            logMessage (juce::String (best, 1) + " ns/sample (recorded " + juce::String (budget, 1)
+                          + ", allowed " + juce::String (allowed, 1) + ")");
+            expectLessOrEqual (best, allowed, scenario.name + " is over its CPU budget");
+        }
+
+        if (getOptions().record)
+        {
+            budgetFile.getParentDirectory().createDirectory();
+            expect (budgetFile.replaceWithText (juce::JSON::toString (juce::var (measured.release()))),
+                    "couldn't write " + budgetFile.getFullPathName());
+        }
+       #endif
+    }
+};
+
+static PerformanceBudgetTest performanceBudgetTest;
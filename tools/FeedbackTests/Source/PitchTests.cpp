@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    What the analysers report for signals whose pitch we know: accuracy in
+    cents, how long a new note takes to show up, and that silence, noise and
+    chords don't produce anything they shouldn't.
+
+  ==============================================================================
+*/
+
+#include "TestHelpers.h"
+
+using namespace TestHelpers;
+
+namespace
+{
+    struct DetectorCase
+    {
+        const char* name;
+        float detector;         // PitchAnalyser::Detector, as the parameter value
+        float maxCents;         // steady-state error allowed on a clean signal
+    };
+
+    // the resonators are a quarter-tone bank, so they're allowed a wider margin than the frame detectors
+    const DetectorCase detectorCases[] { { "FFT", 0.0f, 10.0f }, { "YIN", 1.0f, 10.0f }, { "Resonators", 2.0f, 25.0f } };
+
+    // both ends of the guitar range plus the notes in between, roughly every three semitones
+    const float toneFrequencies[] { 76.0f, 82.41f, 98.0f, 116.54f, 138.59f, 164.81f, 196.0f, 233.08f, 277.18f,
+                                    329.63f, 392.0f, 466.16f, 554.37f, 659.26f, 783.99f, 932.33f, 1108.73f, 1190.0f };
+}
+
+//==============================================================================
+class PitchAccuracyTest  : public juce::UnitTest
+{
+public:
+    PitchAccuracyTest() : juce::UnitTest ("Pitch accuracy", "Pitch") {}
+
+    void runTest() override
+    {
+        for (const auto& detectorCase : detectorCases)
+        {
+            beginTest (juce::String ("Pure tones, ") + detectorCase.name);
+
+            for (auto frequency : toneFrequencies)
+            {
+                auto processor = createProcessor (1, { { ParamIDs::Detector, detectorCase.detector } });
+                auto audio = TestSignals::makeTone (frequency, defaultSampleRate, 1, 1.0);
+                render (*processor, audio, defaultSampleRate, defaultBlockSize);
+
+                expectDetected (processor->getDetectedFrequency (0), frequency, detectorCase.maxCents);
+            }
+
+            beginTest (juce::String ("Plucked notes, ") + detectorCase.name);
+            {
+                const auto& notes = TestSignals::getPluckedNotes();
+                const auto noteLength = static_cast<int> (TestSignals::pluckSeconds * defaultSampleRate);
+
+                // each note is checked near its end, once the attack and the glide from the last note are over
+                std::vector<float> detected (notes.size(), 0.0f);
+                auto processor = createProcessor (1, { { ParamIDs::Detector, detectorCase.detector } });
+                auto audio = TestSignals::makePluckedNotes (defaultSampleRate, 1, TestSignals::pluckSeconds * (double) notes.size());
+
+                render (*processor, audio, defaultSampleRate, defaultBlockSize, [&] (int samplesDone)
+                {
+                    const auto note = (size_t) ((samplesDone - 1) / noteLength);
+                    if (note < notes.size() && (samplesDone - 1) % noteLength >= noteLength * 9 / 10)
+                        detected[note] = processor->getDetectedFrequency (0);
+                });
+
+                for (size_t i = 0; i < notes.size(); i++)
+                    expectDetected (detected[i], notes[i], detectorCase.maxCents * 2.0f);
+            }
+        }
+    }
+
+private:
+    void expectDetected (float detected, float expected, float maxCents)
+    {
+        const auto message = "expected " + juce::String (expected, 2) + " Hz, got " + juce::String (detected, 2) + " Hz";
+
+        expect (detected > 0.0f, message);
+        if (detected > 0.0f)
+            expectLessOrEqual (std::abs (centsBetween (detected, expected)), maxCents, message);
+    }
+};
+
+static PitchAccuracyTest pitchAccuracyTest;
+
+//==============================================================================
+class DetectionLatencyTest  : public juce::UnitTest
+{
+public:
+    DetectionLatencyTest() : juce::UnitTest ("Detection latency", "Pitch") {}
+
+    void runTest() override
+    {
+        // silence, then a note - how many samples until the estimate is within a quarter tone of it
+        constexpr auto frequency = 220.0f;
+        constexpr auto maxCents = 50.0f;
+        const auto onsetSample = static_cast<int> (0.5 * defaultSampleRate);
+
+        for (const auto& detectorCase : detectorCases)
+        {
+            beginTest (detectorCase.name);
+
+            auto processor = createProcessor (1, { { ParamIDs::Detector, detectorCase.detector } });
+            auto audio = TestSignals::makeTone (frequency, defaultSampleRate, 1, 1.5);
+            audio.clear (0, onsetSample);
+
+            auto detectedAt = -1;
+            render (*processor, audio, defaultSampleRate, defaultBlockSize, [&] (int samplesDone)
+            {
+                const auto detected = processor->getDetectedFrequency (0);
+                if (detectedAt < 0 && samplesDone > onsetSample && detected > 0.0f
+                      && std::abs (centsBetween (detected, frequency)) <= maxCents)
+                    detectedAt = samplesDone;
+            });
+
+            // the processor's own figure, plus the block the estimate lands in
+            const auto allowed = processor->getAnalysisLatencySamples() + defaultBlockSize;
+
+            expect (detectedAt > 0, "note never detected");
+            if (detectedAt > 0)
+            {
+                logMessage (juce::String (detectorCase.name) + ": " + juce::String (detectedAt - onsetSample)
+                              + " samples (allowed " + juce::String (allowed) + ")");
+                expectLessOrEqual (detectedAt - onsetSample, allowed);
+            }
+        }
+    }
+};
+
+static DetectionLatencyTest detectionLatencyTest;
+
+//==============================================================================
+class QuietAndNoisyInputTest  : public juce::UnitTest
+{
+public:
+    QuietAndNoisyInputTest() : juce::UnitTest ("Silence and noise", "Pitch") {}
+
+    void runTest() override
+    {
+        for (const auto& detectorCase : detectorCases)
+        {
+            const TestHelpers::ParameterList parameters { { ParamIDs::Detector, detectorCase.detector }, { ParamIDs::Feedback, 1.0f } };
+
+            beginTest (juce::String ("Silence, ") + detectorCase.name);
+            {
+                auto processor = createProcessor (2, parameters);
+                juce::AudioBuffer<float> audio (2, static_cast<int> (2.0 * defaultSampleRate));
+                audio.clear();
+                render (*processor, audio, defaultSampleRate, defaultBlockSize);
+
+                expectEquals (processor->getDetectedFrequency (0), 0.0f, "a pitch was found in silence");
+                expectLessOrEqual (audio.getMagnitude (0, audio.getNumSamples()), 1.0e-6f, "silence in, sound out");
+            }
+
+            beginTest (juce::String ("Noise, ") + detectorCase.name);
+            {
+                auto processor = createProcessor (2, parameters);
+                auto audio = TestSignals::makeNoise (defaultSampleRate, 2, 2.0);
+                const auto inputPeak = audio.getMagnitude (0, audio.getNumSamples());
+                render (*processor, audio, defaultSampleRate, defaultBlockSize);
+
+                // whatever the detectors make of it, the output is the input plus at most a full-scale tone
+                auto finite = true;
+                for (int ch = 0; ch < audio.getNumChannels(); ch++)
+                    for (int i = 0; i < audio.getNumSamples(); i++)
+                        finite = finite && std::isfinite (audio.getSample (ch, i));
+
+                expect (finite, "non-finite output");
+                expectLessOrEqual (audio.getMagnitude (0, audio.getNumSamples()), inputPeak + 1.0f + 1.0e-3f);
+            }
+        }
+    }
+};
+
+static QuietAndNoisyInputTest quietAndNoisyInputTest;
+
+//==============================================================================
+class ChordTest  : public juce::UnitTest
+{
+public:
+    ChordTest() : juce::UnitTest ("Chords", "Pitch") {}
+
+    void runTest() override
+    {
+        beginTest ("Six voices on an open E major");
+
+        const auto& chordNotes = TestSignals::getChordNotes();
+        auto processor = createProcessor (1, { { ParamIDs::Voices, (float) chordNotes.size() } });
+        auto audio = TestSignals::makeChord (defaultSampleRate, 1, 1.5);
+
+        PitchAnalyser::NoteSet notes;
+        auto haveNotes = false;
+        render (*processor, audio, defaultSampleRate, defaultBlockSize, [&] (int)
+        {
+            haveNotes = processor->getDetectedNotes (0, notes) || haveNotes;
+        });
+
+        expect (haveNotes, "no notes published");
+
+        // most of the chord found, and nothing reported that isn't in it
+        auto numFound = 0;
+        for (auto expected : chordNotes)
+        {
+            auto found = false;
+            for (int i = 0; i < notes.numNotes; i++)
+                found = found || std::abs (centsBetween (notes.frequencies[(size_t) i], expected)) <= 25.0f;
+
+            numFound += found ? 1 : 0;
+        }
+
+        for (int i = 0; i < notes.numNotes; i++)
+        {
+            auto closest = std::numeric_limits<float>::max();
+            for (auto expected : chordNotes)
+                closest = juce::jmin (closest, std::abs (centsBetween (notes.frequencies[(size_t) i], expected)));
+
+            expectLessOrEqual (closest, 50.0f, "reported " + juce::String (notes.frequencies[(size_t) i], 2) + " Hz");
+        }
+
+        logMessage (juce::String (numFound) + " of " + juce::String ((int) chordNotes.size()) + " chord notes found");
+        expectGreaterOrEqual (numFound, 4);
+    }
+};
+
+static ChordTest chordTest;
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    Shared plumbing for the DSP tests: command line options, a processor set
+    up the way a test asks for, and a repeatable render with a probe after
+    every block.
+
+  ==============================================================================
+*/
+
+#include "TestHelpers.h"
+
+namespace TestHelpers
+{
+    Options& getOptions()
+    {
+        static Options options;
+        return options;
+    }
+
+    std::unique_ptr<FeedbackAudioProcessor> createProcessor (int numChannels, const ParameterList& parameters)
+    {
+        auto processor = std::make_unique<FeedbackAudioProcessor>();
+        const auto layoutAccepted = OfflineRenderer::setNumChannels (*processor, numChannels);
+        jassertquiet (layoutAccepted);
+
+        for (const auto& [parameterID, value] : parameters)
+        {
+            const auto parameterExists = OfflineRenderer::setParameter (*processor, parameterID, value);
+            jassertquiet (parameterExists);
+        }
+
+        return processor;
+    }
+
+    OfflineRenderer::Report render (FeedbackAudioProcessor& processor, juce::AudioBuffer<float>& audio, double sampleRate,
+                                    int blockSize, std::function<void (int)> afterBlock)
+    {
+        OfflineRenderer::Settings settings;
+        settings.sampleRate = sampleRate;
+        settings.blockSize = blockSize;
+        settings.inlineAnalysis = true;
+        settings.afterBlock = std::move (afterBlock);
+        return OfflineRenderer::render (processor, audio, settings);
+    }
+
+    float centsBetween (float frequency, float reference)
+    {
+        return 1200.0f * std::log2 (frequency / reference);
+    }
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    Shared plumbing for the DSP tests: command line options, a processor set
+    up the way a test asks for, and a repeatable render with a probe after
+    every block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../FeedbackBench/Source/OfflineRenderer.h"
+#include "../../FeedbackBench/Source/BenchmarkScenarios.h"
+
+//==============================================================================
+namespace TestHelpers
+{
+    struct Options
+    {
+        juce::File goldenFolder;            // where the golden renders and the recorded CPU budgets live
+        bool record = false;                // write the golden renders and CPU budgets instead of checking against them
+        double budgetScale = 1.0;           // multiplies every CPU budget, for slower machines
+        bool skipPerformance = false;
+    };
+
+    // set once by main() before any test runs
+    Options& getOptions();
+
+    using ParameterList = std::vector<std::pair<juce::String, float>>;
+
+    // a fresh processor on numChannels in and out, parameters set in their own units
+    std::unique_ptr<FeedbackAudioProcessor> createProcessor (int numChannels, const ParameterList& parameters);
+
+    // processes audio in place with the analysis inline, so the result only depends on the input.
+    // afterBlock gets the number of samples rendered so far
+    OfflineRenderer::Report render (FeedbackAudioProcessor& processor, juce::AudioBuffer<float>& audio, double sampleRate,
+                                    int blockSize, std::function<void (int)> afterBlock = nullptr);
+
+    // signed distance from reference, in cents
+    float centsBetween (float frequency, float reference);
+
+    // constants
+    static constexpr auto defaultSampleRate = 48000.0;
+    static constexpr auto defaultBlockSize = 256;
+}